@@ -147,7 +147,16 @@ Value* ASTToBox::buildStoreAddress(Value *box, FunctionCodeGenerator *fg) const
 
 void ASTToBox::getPutValueIntoBox(Value *box, Value *value, FunctionCodeGenerator *fg) const {
     setBoxInfo(box, fg);
-    fg->builder().CreateStore(value, buildStoreAddress(box, fg));
+    auto address = buildStoreAddress(box, fg);
+    if (value->getType()->isIntegerTy(1)) {
+        // The unused bits of a stored i1 are unspecified, but code reading the box may be compiled separately and
+        // expect a whole byte of 0 or 1.
+        auto byte = llvm::Type::getInt8Ty(fg->generator()->context());
+        fg->builder().CreateStore(fg->builder().CreateZExt(value, byte),
+                                  fg->builder().CreateBitCast(address, byte->getPointerTo()));
+        return;
+    }
+    fg->builder().CreateStore(value, address);
 }
 
 void ASTToBox::setBoxInfo(Value *box, FunctionCodeGenerator *fg) const {
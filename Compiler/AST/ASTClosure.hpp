@@ -36,6 +36,9 @@ public:
     ASTClosure(std::unique_ptr<Function> &&closure, const SourcePosition &p, bool isEscaping);
 
     Type analyse(ExpressionAnalyser *analyser, const TypeExpectation &expectation) override;
+    /// Analyses only the parameters and the return type of the closure and returns its type. The body is left
+    /// unanalysed as boxing, applied once the expected type is known, may still change the parameter types.
+    Type analyseSignature(ExpressionAnalyser *analyser);
     Value* generate(FunctionCodeGenerator *fg) const final;
 
     void toCode(PrettyStream &pretty) const override;
@@ -8,12 +8,15 @@
 
 #include "ASTControlFlow.hpp"
 #include "AST/ASTNode.hpp"
+#include "ASTBinaryOperator.hpp"
+#include "ASTLiterals.hpp"
 #include "ASTMethod.hpp"
 #include "ASTVariables.hpp"
 #include "Analysis/FunctionAnalyser.hpp"
 #include "Compiler.hpp"
 #include "Emojis.h"
 #include "MemoryFlowAnalysis/MFFunctionAnalyser.hpp"
+#include "Parsing/OperatorHelper.hpp"
 #include "Scoping/SemanticScoper.hpp"
 #include "Types/Class.hpp"
 #include "Types/Protocol.hpp"
@@ -130,28 +133,98 @@ void ASTErrorHandler::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
 void ASTForIn::analyse(FunctionAnalyser *analyser) {
     analyser->scoper().pushScope();
 
-    ASTBlock newBlock(position());
+    iterateeType_ = analyser->expect(TypeExpectation(false, false), &iteratee_);
+    auto compiler = analyser->compiler();
+    if (iterateeType_.type() == TypeType::ValueType && iterateeType_.valueType() == compiler->sRange) {
+        analyseRange(analyser);
+        return;
+    }
+
+    auto iterateeVar = U"iteratee" + varName_;
+    auto &var = analyser->scoper().currentScope().declareVariable(iterateeVar, iterateeType_, true, position());
+    analyser->pathAnalyser().record(PathAnalyserIncident(false, var.id()));
+    iterateeVar_ = var.id();
 
-    auto iteratorVar = U"iterator" + varName_;
+    ASTBlock newBlock(position());
 
-    auto getIterator = std::make_shared<ASTMethod>(std::u32string(1, E_DANGO), std::move(iteratee_),
+    if (iterateeType_.type() == TypeType::ValueType && iterateeType_.valueType() == compiler->sList) {
+        lowering_ = Lowering::List;
+
+        auto indexVar = U"index" + varName_;
+        auto countVar = U"count" + varName_;
+
+        auto getCount = std::make_shared<ASTMethod>(U"🐔", std::make_shared<ASTGetVariable>(iterateeVar, position()),
+                                                    ASTArguments(position()), position());
+        newBlock.appendNode(std::make_unique<ASTConstantVariable>(countVar, getCount, position()));
+        newBlock.appendNode(std::make_unique<ASTVariableDeclareAndAssign>(indexVar,
+                                                                          std::make_shared<ASTNumberLiteral>(
+                                                                              static_cast<int64_t>(0), U"0", position()),
+                                                                          position()));
+
+        ASTArguments args(position());
+        args.addArguments(std::make_shared<ASTGetVariable>(indexVar, position()));
+        auto getElement = std::make_shared<ASTMethod>(U"🐽", std::make_shared<ASTGetVariable>(iterateeVar, position()),
+                                                      args, position());
+        block_.prependNode(std::make_unique<ASTOperatorAssignment>(indexVar,
+                                                                   std::make_shared<ASTNumberLiteral>(
+                                                                       static_cast<int64_t>(1), U"1", position()),
+                                                                   position(), OperatorType::Plus));
+        block_.prependNode(std::make_unique<ASTConstantVariable>(varName_, getElement, position()));
+
+        auto hasNext = std::make_shared<ASTBinaryOperator>(OperatorType::Less,
+                                                           std::make_shared<ASTGetVariable>(indexVar, position()),
+                                                           std::make_shared<ASTGetVariable>(countVar, position()),
+                                                           position());
+        newBlock.appendNode(std::make_unique<ASTRepeatWhile>(hasNext, std::move(block_), position()));
+    }
+    else {
+        auto iteratorVar = U"iterator" + varName_;
+
+        auto getIterator = std::make_shared<ASTMethod>(std::u32string(1, E_DANGO),
+                                                       std::make_shared<ASTGetVariable>(iterateeVar, position()),
+                                                       ASTArguments(position()), position());
+        newBlock.appendNode(std::make_unique<ASTConstantVariable>(iteratorVar, getIterator, position()));
+        auto getNext = std::make_shared<ASTMethod>(std::u32string(1, 0x1F53D),
+                                                   std::make_shared<ASTGetVariable>(iteratorVar, position()),
                                                    ASTArguments(position()), position());
-    newBlock.appendNode(std::make_unique<ASTConstantVariable>(iteratorVar, getIterator, position()));
-    auto getNext = std::make_shared<ASTMethod>(std::u32string(1, 0x1F53D),
-                                               std::make_shared<ASTGetVariable>(iteratorVar, position()),
-                                               ASTArguments(position()), position());
-    block_.prependNode(std::make_unique<ASTConstantVariable>(varName_, getNext, position()));
-
-    auto hasNext = std::make_shared<ASTMethod>(std::u32string(1, 0x1F53D),
-                                               std::make_shared<ASTGetVariable>(iteratorVar, position()),
-                                               ASTArguments(position(), Mood::Interogative), position());
-    newBlock.appendNode(std::make_unique<ASTRepeatWhile>(hasNext, std::move(block_), position()));
+        block_.prependNode(std::make_unique<ASTConstantVariable>(varName_, getNext, position()));
+
+        auto hasNext = std::make_shared<ASTMethod>(std::u32string(1, 0x1F53D),
+                                                   std::make_shared<ASTGetVariable>(iteratorVar, position()),
+                                                   ASTArguments(position(), Mood::Interogative), position());
+        newBlock.appendNode(std::make_unique<ASTRepeatWhile>(hasNext, std::move(block_), position()));
+    }
+
     block_ = std::move(newBlock);
     block_.analyse(analyser);
     block_.popScope(analyser);
 }
 
+void ASTForIn::analyseRange(FunctionAnalyser *analyser) {
+    lowering_ = Lowering::Range;
+    elementType_ = analyser->integer();
+
+    analyser->pathAnalyser().beginBranch();
+    analyser->scoper().checkForShadowing(varName_, position(), analyser->compiler());
+    auto &var = analyser->scoper().currentScope().declareVariable(varName_, elementType_, true, position());
+    analyser->pathAnalyser().record(PathAnalyserIncident(false, var.id()));
+    elementVar_ = var.id();
+
+    block_.analyse(analyser);
+    block_.popScope(analyser);
+    analyser->pathAnalyser().endBranch();
+    analyser->pathAnalyser().finishUncertainBranches();
+}
+
 void ASTForIn::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
+    if (lowering_ == Lowering::Range) {
+        iteratee_->analyseMemoryFlow(analyser, MFFlowCategory::Borrowing);
+        analyser->recordVariableSet(elementVar_, nullptr, elementType_);
+    }
+    else {
+        analyser->take(iteratee_.get());
+        analyser->recordVariableSet(iterateeVar_, iteratee_.get(), iterateeType_);
+    }
     block_.analyseMemoryFlow(analyser);
     analyser->popScope(&block_);
 }
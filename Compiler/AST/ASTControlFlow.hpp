@@ -73,9 +73,22 @@ public:
     void analyseMemoryFlow(MFFunctionAnalyser *analyser) override;
 
 private:
+    /// Determines how the loop is lowered. 🍨 and ⏩ are iterated by index directly without an iterator.
+    enum class Lowering {
+        Iterator, List, Range
+    };
+
+    void analyseRange(FunctionAnalyser *analyser);
+    void generateRange(FunctionCodeGenerator *fg) const;
+
     std::shared_ptr<ASTExpr> iteratee_;
     ASTBlock block_;
     std::u32string varName_;
+    Lowering lowering_ = Lowering::Iterator;
+    Type iterateeType_ = Type::noReturn();
+    Type elementType_ = Type::noReturn();
+    VariableID iterateeVar_;
+    VariableID elementVar_;
 };
 
 class ASTErrorHandler final : public ASTStatement, public ErrorHandling {
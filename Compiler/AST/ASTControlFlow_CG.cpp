@@ -127,7 +127,50 @@ void ASTErrorHandler::generate(FunctionCodeGenerator *fg) const {
 }
 
 void ASTForIn::generate(FunctionCodeGenerator *fg) const {
+    if (lowering_ == Lowering::Range) {
+        generateRange(fg);
+        return;
+    }
+    fg->setVariable(iterateeVar_, iteratee_->generate(fg));
+    fg->releaseTemporaryObjects();
     block_.generate(fg);
 }
 
+void ASTForIn::generateRange(FunctionCodeGenerator *fg) const {
+    auto *function = fg->builder().GetInsertBlock()->getParent();
+
+    auto range = iteratee_->generate(fg);
+    fg->releaseTemporaryObjects();
+    auto start = fg->builder().CreateExtractValue(range, 0);
+    auto stop = fg->builder().CreateExtractValue(range, 1);
+    auto step = fg->builder().CreateExtractValue(range, 2);
+    // Same number of iterations as ⏩🐔
+    auto count = fg->builder().CreateSDiv(fg->builder().CreateSub(stop, start), step);
+
+    auto entryBlock = fg->builder().GetInsertBlock();
+    auto afterBlock = llvm::BasicBlock::Create(fg->ctx(), "afterForIn");
+    auto condBlock = llvm::BasicBlock::Create(fg->ctx(), "forInCond", function);
+    auto repeatBlock = llvm::BasicBlock::Create(fg->ctx(), "forIn", function);
+
+    fg->builder().CreateBr(condBlock);
+
+    fg->builder().SetInsertPoint(condBlock);
+    auto index = fg->builder().CreatePHI(fg->builder().getInt64Ty(), 2);
+    index->addIncoming(fg->int64(0), entryBlock);
+    fg->builder().CreateCondBr(fg->builder().CreateICmpSLT(index, count), repeatBlock, afterBlock);
+
+    fg->builder().SetInsertPoint(repeatBlock);
+    auto element = fg->builder().CreateAdd(start, fg->builder().CreateMul(index, step));
+    fg->setVariable(elementVar_, element);
+    block_.generate(fg);
+
+    if (!block_.returnedCertainly()) {
+        index->addIncoming(fg->builder().CreateAdd(index, fg->int64(1)), fg->builder().GetInsertBlock());
+        fg->builder().CreateBr(condBlock);
+    }
+
+    function->getBasicBlockList().push_back(afterBlock);
+    fg->builder().SetInsertPoint(afterBlock);
+}
+
 }  // namespace EmojicodeCompiler
@@ -77,25 +77,45 @@ Type ASTNoValue::analyse(ExpressionAnalyser *analyser, const TypeExpectation &ex
 }
 
 Type ASTDictionaryLiteral::analyse(ExpressionAnalyser *analyser, const TypeExpectation &expectation) {
-    type_ = Type(analyser->compiler()->sDictionary);
+    auto dictionary = analyser->compiler()->sDictionary;
+    type_ = Type(dictionary);
     type_.typeDefinition()->lookupInitializer(U"🐴")->createUnspecificReification();
     type_.typeDefinition()->lookupMethod(U"🐽", Mood::Assignment)->createUnspecificReification();
 
-    CommonTypeFinder finder;
-    for (auto it = values_.begin(); it != values_.end(); it++) {
-        analyser->expectType(Type(analyser->compiler()->sString), &*it);
-        if (++it == values_.end()) {
-            throw CompilerError(position(), "A value must be provided for every key.");
+    if (values_.size() % 2 != 0) {
+        throw CompilerError(position(), "A value must be provided for every key.");
+    }
+
+    if (expectation.type() == TypeType::ValueType && expectation.valueType() == dictionary) {
+        auto keyType = dictionary->typeForVariable(0).resolveOn(TypeContext(expectation.copyType()));
+        auto elementType = dictionary->typeForVariable(1).resolveOn(TypeContext(expectation.copyType()));
+        for (auto it = values_.begin(); it != values_.end(); it += 2) {
+            analyser->expectType(keyType, &*it);
+            analyser->expectType(elementType, &*(it + 1));
         }
-        finder.addType(analyser->expect(TypeExpectation(), &(*it)), analyser->typeContext());
+        type_ = expectation.copyType();
+        type_.setExact(true);
+        return type_;
     }
 
-    type_.setGenericArgument(0, finder.getCommonType(position(), analyser->compiler()));
-    type_.setExact(true);
+    CommonTypeFinder keyFinder;
+    CommonTypeFinder finder;
+    for (auto it = values_.begin(); it != values_.end(); it += 2) {
+        keyFinder.addType(analyser->expect(TypeExpectation(), &*it), analyser->typeContext());
+        finder.addType(analyser->expect(TypeExpectation(), &*(it + 1)), analyser->typeContext());
+    }
 
-    auto elementType = analyser->compiler()->sList->typeForVariable(0).resolveOn(TypeContext(type_));
-    for (auto it = values_.begin() + 1; it - 1 != values_.end(); it += 2) {
-        analyser->comply((*it)->expressionType(), TypeExpectation(elementType), &(*it));
+    type_.setGenericArgument(0, keyFinder.getCommonType(position(), analyser->compiler()));
+    type_.setGenericArgument(1, finder.getCommonType(position(), analyser->compiler()));
+    type_.setExact(true);
+    dictionary->requestReificationAndCheck(analyser->typeContext(), TypeContext(type_), type_.genericArguments(),
+                                           position());
+
+    auto keyType = dictionary->typeForVariable(0).resolveOn(TypeContext(type_));
+    auto elementType = dictionary->typeForVariable(1).resolveOn(TypeContext(type_));
+    for (auto it = values_.begin(); it != values_.end(); it += 2) {
+        analyser->comply((*it)->expressionType(), TypeExpectation(keyType), &*it);
+        analyser->comply((*(it + 1))->expressionType(), TypeExpectation(elementType), &*(it + 1));
     }
 
     return type_;
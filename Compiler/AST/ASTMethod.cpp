@@ -155,6 +155,8 @@ void ASTMethodable::prepareBuiltIns(Compiler *c) {
         {{c->sInteger, E_NO_ENTRY_SIGN}, BuiltInType::IntegerNot},
         {{c->sInteger, E_BATTERY}, BuiltInType::IntegerInverse},
         {{c->sInteger, 0x1f4a7}, BuiltInType::IntegerToByte},
+        {{c->sInteger, 0x23ec}, BuiltInType::IntegerTrailingZeros},
+        {{c->sInteger, 0x1f9ee}, BuiltInType::IntegerPopCount},
         {{c->sByte, E_NO_ENTRY_SIGN}, BuiltInType::IntegerNot},
         {{c->sByte, E_BATTERY}, BuiltInType::IntegerInverse},
         {{c->sByte, 0x1f522}, BuiltInType::ByteToInteger},
@@ -172,6 +174,7 @@ void ASTMethodable::prepareBuiltIns(Compiler *c) {
         {{c->sMemory, 0x1F69C}, BuiltInType::MemoryMove},
         {{c->sMemory, 0x270D}, BuiltInType::MemorySet},
         {{c->sMemory, 0x1F43D}, BuiltInType::Load},
+        {{c->sMemory, 0x1F4E0}, BuiltInType::MemoryIsTrivial},
     };
 }
 
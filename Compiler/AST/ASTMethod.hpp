@@ -38,9 +38,11 @@ protected:
         Round, DoubleAbs, DoubleToInteger,
         IntegerMultiply, IntegerAdd, IntegerSubstract, IntegerDivide, IntegerGreater, IntegerGreaterOrEqual,
         IntegerLess, IntegerLessOrEqual, IntegerLeftShift, IntegerRightShift, IntegerOr, IntegerAnd, IntegerXor,
-        IntegerRemainder, IntegerToDouble, IntegerNot, IntegerInverse, IntegerToByte, ByteToInteger,
+        IntegerRemainder, IntegerToDouble, IntegerNot, IntegerInverse, IntegerToByte, IntegerTrailingZeros,
+        IntegerPopCount,
+        ByteToInteger,
         BooleanAnd, BooleanOr, BooleanNegate,
-        Equal, Store, Load, Release, MemoryMove, MemorySet, IsNoValueLeft, IsNoValueRight, Multiprotocol,
+        Equal, Store, Load, Release, MemoryMove, MemorySet, MemoryIsTrivial, IsNoValueLeft, IsNoValueRight, Multiprotocol,
     };
 
     BuiltInType builtIn_ = BuiltInType::None;
@@ -86,6 +88,9 @@ private:
     llvm::Value* buildMemoryAddress(FunctionCodeGenerator *fg, llvm::Value *memory, llvm::Value *offset,
                                     const Type &type) const;
     llvm::Value* buildAddOffsetAddress(FunctionCodeGenerator *fg, llvm::Value *memory, llvm::Value *offset) const;
+    /// Determines whether the values described by the arguments of 📠 can be copied without retaining them. This is
+    /// decided at compile time unless the values are boxed, in which case the box infos are inspected.
+    llvm::Value* buildIsTrivial(FunctionCodeGenerator *fg, llvm::Value *memory) const;
 };
     
 }  // namespace EmojicodeCompiler
@@ -9,7 +9,9 @@
 #include "ASTMethod.hpp"
 #include "ASTType.hpp"
 #include "Generation/CallCodeGenerator.hpp"
+#include "Generation/CodeGenerator.hpp"
 #include "Generation/FunctionCodeGenerator.hpp"
+#include "Generation/RunTimeHelper.hpp"
 
 namespace EmojicodeCompiler {
 
@@ -29,6 +31,10 @@ Value* ASTMethod::generate(FunctionCodeGenerator *fg) const {
                 return fg->builder().CreateMul(v, llvm::ConstantInt::get(v->getType(), -1));
             case BuiltInType::IntegerToByte:
                 return fg->builder().CreateTrunc(v, llvm::Type::getInt8Ty(fg->ctx()));
+            case BuiltInType::IntegerTrailingZeros:
+                return callIntrinsic(fg, llvm::Intrinsic::ID::cttz, {v, llvm::ConstantInt::getFalse(fg->ctx())});
+            case BuiltInType::IntegerPopCount:
+                return callIntrinsic(fg, llvm::Intrinsic::ID::ctpop, v);
             case BuiltInType::ByteToInteger:
                 return fg->builder().CreateSExt(v, llvm::Type::getInt64Ty(fg->ctx()));
             case BuiltInType::DoubleInverse:
@@ -92,6 +98,8 @@ Value* ASTMethod::generate(FunctionCodeGenerator *fg) const {
                                            args_.args()[0]->generate(fg), args_.args()[2]->generate(fg), 0);
                 return nullptr;
             }
+            case BuiltInType::MemoryIsTrivial:
+                return buildIsTrivial(fg, v);
             case BuiltInType::Multiprotocol:
                 return MultiprotocolCallCodeGenerator(fg, callType_).generate(callee_->generate(fg), calleeType_, args_,
                                                                               method_, errorPointer(), multiprotocolN_);
@@ -115,4 +123,51 @@ Value* ASTMethod::buildMemoryAddress(FunctionCodeGenerator *fg, llvm::Value *mem
     return fg->builder().CreateBitCast(buildAddOffsetAddress(fg, memory, offset), ptrType);
 }
 
+Value* ASTMethod::buildIsTrivial(FunctionCodeGenerator *fg, llvm::Value *memory) const {
+    auto type = args_.genericArguments().front()->type();
+    if (!type.isManaged()) {
+        return llvm::ConstantInt::getTrue(fg->ctx());
+    }
+    if (type.type() != TypeType::Box) {
+        return llvm::ConstantInt::getFalse(fg->ctx());
+    }
+
+    // A box can be copied bit by bit if it is empty or if the boxed type uses the trivial retain function.
+    auto address = buildAddOffsetAddress(fg, memory, args_.args()[0]->generate(fg));
+    auto count = args_.args()[1]->generate(fg);
+    auto stride = args_.args()[2]->generate(fg);
+    auto trivial = fg->generator()->runTime().trivialBoxRetainRelease();
+
+    auto entry = fg->builder().GetInsertBlock();
+    auto loop = fg->createBlock("trivialLoop");
+    auto inspect = fg->createBlock("trivialInspect");
+    auto next = fg->createBlock("trivialNext");
+    auto done = fg->createBlock("trivialDone");
+    fg->builder().CreateCondBr(fg->builder().CreateICmpSGT(count, fg->int64(0)), loop, done);
+
+    fg->builder().SetInsertPoint(loop);
+    auto index = fg->builder().CreatePHI(llvm::Type::getInt64Ty(fg->ctx()), 2);
+    index->addIncoming(fg->int64(0), entry);
+    auto boxPtr = fg->builder().CreateBitCast(fg->builder().CreateGEP(address, fg->builder().CreateMul(index, stride)),
+                                              fg->typeHelper().box()->getPointerTo());
+    auto boxInfo = fg->builder().CreateLoad(fg->buildGetBoxInfoPtr(boxPtr));
+    fg->builder().CreateCondBr(fg->builder().CreateIsNull(boxInfo), next, inspect);
+
+    fg->builder().SetInsertPoint(inspect);
+    auto retain = fg->builder().CreateLoad(fg->buildGetBoxRetainReleasePtr(true, boxInfo, type));
+    fg->builder().CreateCondBr(fg->builder().CreateICmpEQ(retain, trivial), next, done);
+
+    fg->builder().SetInsertPoint(next);
+    auto nextIndex = fg->builder().CreateAdd(index, fg->int64(1));
+    index->addIncoming(nextIndex, next);
+    fg->builder().CreateCondBr(fg->builder().CreateICmpSLT(nextIndex, count), loop, done);
+
+    fg->builder().SetInsertPoint(done);
+    auto result = fg->builder().CreatePHI(llvm::Type::getInt1Ty(fg->ctx()), 3);
+    result->addIncoming(llvm::ConstantInt::getTrue(fg->ctx()), entry);
+    result->addIncoming(llvm::ConstantInt::getFalse(fg->ctx()), inspect);
+    result->addIncoming(llvm::ConstantInt::getTrue(fg->ctx()), next);
+    return result;
+}
+
 }  // namespace EmojicodeCompiler
@@ -44,8 +44,8 @@ Type ASTTypeId::getType(const TypeContext &typeContext) const {
     for (auto &arg : genericArgs_) {
         args.emplace_back(arg->analyseType(typeContext));
     }
-    typeDef->requestReificationAndCheck(typeContext, args, position());
-    type.setGenericArguments(std::move(args));
+    type.setGenericArguments(std::vector<Type>(args));
+    typeDef->requestReificationAndCheck(typeContext, TypeContext(type), args, position());
     return type;
 }
 
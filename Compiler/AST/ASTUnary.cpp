@@ -26,13 +26,14 @@ Type ASTUnwrap::analyse(ExpressionAnalyser *analyser, const TypeExpectation &exp
 
     Type t = analyser->expect(TypeExpectation(false, false), &expr_);
 
-    if (t.unboxedType() == TypeType::Optional) {
-        return t.optionalType();
-    }
+    // The error of an error-prone call is unwrapped even if the call returns an optional, as it is marked handled.
     if (call != nullptr && call->isErrorProne()) {
         error_ = true;
         return t;
     }
+    if (t.unboxedType() == TypeType::Optional) {
+        return t.optionalType();
+    }
 
     throw CompilerError(position(), "🍺 can only be used with optionals or error-prone calls.");
 }
@@ -87,7 +87,7 @@ Type ExpressionAnalyser::analyseFunctionCall(ASTArguments *node, const Type &typ
     auto genericArgs = transformTypeAstVector(node->genericArguments(), typeContext());
 
     TypeContext typeContext = TypeContext(type, function, &genericArgs);
-    function->requestReificationAndCheck(typeContext, genericArgs, node->position());
+    function->requestReificationAndCheck(typeContext, typeContext, genericArgs, node->position());
 
     for (size_t i = 0; i < function->parameters().size(); i++) {
         expectType(function->parameters()[i].type->type().resolveOn(typeContext), &node->args()[i]);
@@ -146,7 +146,18 @@ void ExpressionAnalyser::ensureGenericArguments(ASTArguments *node, const Type &
         TypeContext typeContext = TypeContext(type, function, nullptr);
         size_t i = 0;
         for (auto &arg : function->parameters()) {
-            expectType(arg.type->type().resolveOn(typeContext), &node->args()[i++], &genericArgsFinders);
+            auto &argNode = node->args()[i++];
+            auto type = arg.type->type().resolveOn(typeContext);
+            // A closure's body must only be analysed once: the arguments are analysed again with the inferred types.
+            if (auto closure = std::dynamic_pointer_cast<ASTClosure>(argNode)) {
+                auto closureType = closure->analyseSignature(this);
+                if (!closureType.compatibleTo(type, typeContext_, &genericArgsFinders)) {
+                    throw CompilerError(argNode->position(), closureType.toString(typeContext_),
+                                        " is not compatible to ", type.toString(typeContext_), ".");
+                }
+                continue;
+            }
+            expectType(type, &argNode, &genericArgsFinders);
         }
         for (auto &finder : genericArgsFinders) {
             auto commonType = finder.getCommonType(node->position(), compiler());
@@ -254,8 +265,12 @@ void ExpressionAnalyser::makeIntoBox(Type &exprType, const TypeExpectation &expe
                                    std::shared_ptr<ASTExpr> *node) const {
     switch (exprType.storageType()) {
         case StorageType::Box:
+            // Boxes for the same protocol contain the same conformance, whatever the generic arguments.
             if (expectation.type() == TypeType::Box &&
-                !exprType.boxedFor().identicalTo(expectation.boxedFor(), typeContext(), nullptr)) {
+                !exprType.boxedFor().identicalTo(expectation.boxedFor(), typeContext(), nullptr) &&
+                !(exprType.boxedFor().type() == TypeType::Protocol &&
+                  expectation.boxedFor().type() == TypeType::Protocol &&
+                  exprType.boxedFor().protocol() == expectation.boxedFor().protocol())) {
                 exprType = exprType.unboxed().boxedFor(expectation.boxedFor());
                 insertNode<ASTRebox>(node, exprType);
             }
@@ -125,7 +125,7 @@ void FunctionAnalyser::initOptionalInstanceVariables() {
                                                                               var.expr, function()->position(), false);
             function()->ast()->prependNode(std::move(assign));
         }
-        else if (var.type->type().type() == TypeType::Optional) {
+        else if (var.type->type().unboxedType() == TypeType::Optional) {
             auto &instanceVariable = scoper_->instanceScope()->getLocalVariable(var.name);
             auto noValue = std::make_shared<ASTNoValue>(function()->position());
             auto assign = std::make_unique<ASTInstanceVariableInitialization>(instanceVariable.name(),
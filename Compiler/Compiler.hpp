@@ -192,6 +192,7 @@ public:
     Class *sError = nullptr;
     ValueType *sList = nullptr;
     ValueType *sDictionary = nullptr;
+    ValueType *sRange = nullptr;
     Protocol *sEnumerable = nullptr;
     ValueType *sBoolean = nullptr;
     ValueType *sInteger = nullptr;
@@ -267,11 +267,16 @@ void CodeGenerator::addParamDereferenceable(const Type &type, size_t index, llvm
 }
 
 llvm::Function::LinkageTypes CodeGenerator::linkageForFunction(Function *function) const {
+    // A closure in an inline function of an imported package is generated again with the function. It must not be
+    // available_externally as the package does not export its closures.
+    if (function->isClosure()) {
+        return llvm::Function::PrivateLinkage;
+    }
     if (function->isInline() && function->package()->isImported()) {
         return llvm::Function::AvailableExternallyLinkage;
     }
-    if ((function->accessLevel() == AccessLevel::Private && !function->isExternal() &&
-         (function->owner() == nullptr || !function->owner()->exported())) || function->isClosure()) {
+    if (function->accessLevel() == AccessLevel::Private && !function->isExternal() &&
+        (function->owner() == nullptr || !function->owner()->exported())) {
         return llvm::Function::PrivateLinkage;
     }
     return llvm::Function::ExternalLinkage;
@@ -458,15 +458,17 @@ void FunctionCodeGenerator::retain(llvm::Value *value, const Type &otype) {
     }
 }
 
-void FunctionCodeGenerator::manageBox(bool retain, llvm::Value *boxInfo, llvm::Value *value, const Type &type) {
-    llvm::Value *fnPtr;
+llvm::Value* FunctionCodeGenerator::buildGetBoxRetainReleasePtr(bool retain, llvm::Value *boxInfo,
+                                                                 const Type &type) {
     if (type.boxedFor().type() == TypeType::Protocol) {
         auto conf = builder().CreateBitCast(boxInfo, typeHelper().protocolConformance()->getPointerTo());
-        fnPtr = builder().CreateConstInBoundsGEP2_32(typeHelper().protocolConformance(), conf, 0, retain ? 3 : 4);
-    }
-    else {
-        fnPtr = builder().CreateConstInBoundsGEP2_32(typeHelper().boxInfo(), boxInfo, 0, retain ? 1 : 2);
+        return builder().CreateConstInBoundsGEP2_32(typeHelper().protocolConformance(), conf, 0, retain ? 3 : 4);
     }
+    return builder().CreateConstInBoundsGEP2_32(typeHelper().boxInfo(), boxInfo, 0, retain ? 1 : 2);
+}
+
+void FunctionCodeGenerator::manageBox(bool retain, llvm::Value *boxInfo, llvm::Value *value, const Type &type) {
+    auto fnPtr = buildGetBoxRetainReleasePtr(retain, boxInfo, type);
     auto call = builder().CreateCall(builder().CreateLoad(fnPtr, retain ? "retain" : "release"), value);
     call->addParamAttr(0, llvm::Attribute::NoCapture);
     call->addParamAttr(0, llvm::Attribute::ReadOnly);
@@ -105,6 +105,10 @@ public:
     /// @param box Pointer to a box.
     /// @param llvmType The type to which the pointer to the field is cast. Must be a pointer type.
     llvm::Value* buildGetBoxValuePtrAfter(llvm::Value *box, llvm::Type *llvmType, llvm::Type *after);
+    /// Gets a pointer to the retain or release function of a box of @c type.
+    /// @param boxInfo The box info loaded from the box, which is a protocol conformance if the box was boxed for a
+    ///                protocol.
+    llvm::Value* buildGetBoxRetainReleasePtr(bool retain, llvm::Value *boxInfo, const Type &type);
     llvm::Value* buildHasNoValueBox(llvm::Value *box);
     llvm::Value* buildHasNoValueBoxPtr(llvm::Value *box);
     llvm::Value* buildBoxWithoutValue();
@@ -15,6 +15,7 @@
 #include <llvm/IR/Function.h>
 #include <llvm/IR/GlobalValue.h>
 #include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/Instructions.h>
 #include <llvm/IR/Type.h>
 
 namespace EmojicodeCompiler {
@@ -103,6 +104,13 @@ void RunTimeHelper::declareRunTime() {
     somethingRTTI_ = createAbstractRtti("something_rtti");
     someobjectRTTI_ = createAbstractRtti("someobject_rtti");
 
+    trivialBoxRetainRelease_ = llvm::Function::Create(generator_->typeHelper().boxRetainRelease(),
+                                                      llvm::GlobalValue::LinkageTypes::LinkOnceODRLinkage,
+                                                      "trivial.boxRetainRelease", generator_->module());
+    trivialBoxRetainRelease_->addFnAttr(llvm::Attribute::NoUnwind);
+    llvm::ReturnInst::Create(generator_->context(),
+                             llvm::BasicBlock::Create(generator_->context(), "entry", trivialBoxRetainRelease_));
+
     // This has to be last as buildRetainRelease uses functions declared above!
     boxInfoClassObjects_ = declareBoxInfo("class.boxInfo");
     classObjectRetainRelease_ = buildRetainRelease(Type(generator_->compiler()->sString), "class.boxRetain",
@@ -74,6 +74,9 @@ public:
     llvm::GlobalVariable* boxInfoForCallables() { return boxInfoCallables_; }
 
     std::pair<llvm::Function*, llvm::Function*> classObjectRetainRelease() const { return classObjectRetainRelease_; }
+    /// The box retain and release function of all types that are not managed. Its address is shared by all packages
+    /// so that the run-time can tell whether a boxed value can be copied bit by bit.
+    llvm::Function* trivialBoxRetainRelease() const { return trivialBoxRetainRelease_; }
 
     llvm::Constant* createRtti(TypeDefinition *generic, RunTimeTypeInfoFlags::Flags flag);
 
@@ -109,6 +112,7 @@ private:
     llvm::GlobalVariable *someobjectRTTI_ = nullptr;
 
     std::pair<llvm::Function*, llvm::Function*> classObjectRetainRelease_ = { nullptr, nullptr };
+    llvm::Function *trivialBoxRetainRelease_ = nullptr;
 
     llvm::Function* declareRunTimeFunction(const char *name, llvm::Type *returnType, llvm::ArrayRef<llvm::Type *> args);
     llvm::Function* declareMemoryRunTimeFunction(const char *name);
@@ -55,7 +55,9 @@ void TypeBodyParser<TypeDef>::parseFunction(Function *function, bool inititalize
         throw CompilerError(function->position(), "Only classes can have error-prone initializers.");
     }
     parseFunctionBody(function);
-    if (escaping) {
+    // The interface marks inline functions with 🎍🥡 if this escapes. Their bodies must still be analysed, otherwise
+    // none of their values are ever taken, and the analysis determines whether this escapes anyway.
+    if (escaping && !(interface_ && function->ast() != nullptr)) {
         function->setMemoryFlowTypeForThis(MFFlowCategory::Escaping);
     }
     else if (function->isExternal()) {
@@ -55,7 +55,10 @@ public:
     Type typeForVariable(size_t n) {
         assert(offset_ <= n && n < offset_ + genericParameters_.size());
         Type type = Type(n, static_cast<T *>(this));
-        if (genericParameters_[n - offset_].useBox) {
+        // A constraint may refer to its own variable (e.g. `🔣🐚Key🍆`). While it is being analysed, the variable
+        // cannot be boxed for it yet.
+        auto &parameter = genericParameters_[n - offset_];
+        if (parameter.useBox && parameter.constraint->wasAnalysed()) {
             type = type.boxedFor(constraintForIndex(n));
         }
         return type;
@@ -77,18 +80,22 @@ public:
         parameterVariables_.emplace(variableName, parameterVariables_.size());
     }
 
-    void requestReificationAndCheck(const TypeContext &typeContext, const std::vector<Type> &args,
-                                    const SourcePosition &p) {
+    /// Checks that @c args satisfy the constraints and requests a reification for them.
+    /// @param constraintContext The context on which the constraints are resolved before checking. This allows a
+    ///                          constraint to refer to the generic parameters themselves, e.g. `🔣🐚Key🍆`.
+    void requestReificationAndCheck(const TypeContext &typeContext, const TypeContext &constraintContext,
+                                    const std::vector<Type> &args, const SourcePosition &p) {
         if (args.size() - offset_ != genericParameters().size()) {
             throw CompilerError(p, "Expected ", genericParameters().size(), " generic arguments, but ",
                                 args.size(), " are provided.");
         }
 
         for (size_t i = offset_; i < args.size(); i++) {
-            if (!args[i].compatibleTo(constraintForIndex(i), typeContext)) {
+            auto constraint = constraintForIndex(i).resolveOn(constraintContext);
+            if (!args[i].compatibleTo(constraint, typeContext)) {
                 throw CompilerError(p, "Generic argument ", i + 1, " of type ",
                                     args[i].toString(typeContext), " is not compatible to constraint ",
-                                    constraintForIndex(offset_ + i).toString(typeContext), ".");
+                                    constraint.toString(typeContext), ".");
             }
         }
 
@@ -137,7 +137,9 @@ Type Type::optionalized() const {
 
 Type Type::optionalType() const {
     if (type() == TypeType::Box) {
-        return genericArguments_[0].optionalType().boxedFor(boxedFor());
+        auto type = genericArguments_[0].optionalType();
+        // The optional of a generic variable holds the variable's box already.
+        return type.type() == TypeType::Box ? type : type.boxedFor(boxedFor());
     }
 
     assert(type() == TypeType::Optional);
@@ -262,8 +264,10 @@ Type Type::resolveOnSuperArgumentsAndConstraints(const TypeContext &typeContext)
 std::vector<Type> Type::selfResolvedGenericArgs() const {
     TypeContext typeContext(*this);
     auto args = genericArguments_;
-    for (auto &g : args) {
-        g = g.resolveOn(typeContext);
+    // Only the arguments passed to the superclass refer to the generic variables of this type. The other arguments
+    // are expressed in the context in which the type was written.
+    for (size_t i = 0; i < typeDefinition()->superGenericArguments().size(); i++) {
+        args[i] = args[i].resolveOn(typeContext);
     }
     return args;
 }
@@ -281,9 +285,13 @@ Type Type::resolveOn(const TypeContext &typeContext) const {
         return t;
     }
 
+    // Generic arguments are already expressed in the context of the caller. They must not be resolved again as they
+    // may refer to the generic variables of the callee type itself, e.g. `🌊🐚👫🐚Element Other🍆🍆`.
+    bool resolved = false;
     while (t.unboxedType() == TypeType::LocalGenericVariable && typeContext.function() == t.localResolutionConstraint()
            && typeContext.functionGenericArguments() != nullptr) {
         t = (*typeContext.functionGenericArguments())[t.genericVariableIndex()];
+        resolved = true;
     }
 
     if (typeContext.calleeType().canHaveGenericArguments()) {
@@ -296,10 +304,11 @@ Type Type::resolveOn(const TypeContext &typeContext) const {
                 break;
             }
             t = tn;
+            resolved = true;
         }
     }
 
-    if (t.type() != TypeType::Box) {
+    if (t.type() != TypeType::Box && !resolved) {
         for (auto &arg : t.genericArguments_) {
             arg = arg.resolveOn(typeContext);
         }
@@ -199,6 +199,12 @@ extern "C" bool ejcIsOnlyReference(runtime::Object<void> *object) {
     return controlBlock->strongCount == 1;
 }
 
+extern "C" bool ejcMemoryIsOnlyReference(int8_t **self, runtime::Integer offset) {
+    auto object = *reinterpret_cast<runtime::Object<void> **>(*self + sizeof(runtime::internal::ControlBlock*) +
+                                                               offset);
+    return ejcIsOnlyReference(object);
+}
+
 extern "C" [[noreturn]] void ejcPanic(const char *message) {
     std::cout << "🤯 Program panicked: " << message << std::endl;
     abort();
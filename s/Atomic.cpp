@@ -0,0 +1,209 @@
+//
+//  Atomic.cpp
+//  Emojicode
+//
+
+#include "../runtime/Runtime.h"
+#include <atomic>
+
+namespace s {
+
+/// Translates a 🎼 value to the corresponding std::memory_order. The values of 🎼 are declared in this order.
+std::memory_order memoryOrder(runtime::Enum order) {
+    switch (order) {
+        case 0:
+            return std::memory_order_relaxed;
+        case 1:
+            return std::memory_order_acquire;
+        case 2:
+            return std::memory_order_release;
+        case 3:
+            return std::memory_order_acq_rel;
+        default:
+            return std::memory_order_seq_cst;
+    }
+}
+
+/// Returns the strongest ordering allowed for a load that is not stronger than *order*.
+std::memory_order loadOrder(runtime::Enum order) {
+    switch (memoryOrder(order)) {
+        case std::memory_order_release:
+            return std::memory_order_relaxed;
+        case std::memory_order_acq_rel:
+            return std::memory_order_acquire;
+        default:
+            return memoryOrder(order);
+    }
+}
+
+/// Returns the strongest ordering allowed for a store that is not stronger than *order*.
+std::memory_order storeOrder(runtime::Enum order) {
+    switch (memoryOrder(order)) {
+        case std::memory_order_acquire:
+            return std::memory_order_relaxed;
+        case std::memory_order_acq_rel:
+            return std::memory_order_release;
+        default:
+            return memoryOrder(order);
+    }
+}
+
+class AtomicInteger : public runtime::Object<AtomicInteger> {
+public:
+    explicit AtomicInteger(runtime::Integer value) : value(value) {}
+    std::atomic<runtime::Integer> value;
+};
+
+class AtomicBoolean : public runtime::Object<AtomicBoolean> {
+public:
+    explicit AtomicBoolean(bool value) : value(value) {}
+    std::atomic<bool> value;
+};
+
+/// Holds a strong reference to an object. Loading must retain the object before another thread can replace and
+/// release it, therefore all accesses are serialized with a spin lock that is held only for a few instructions.
+class AtomicReference : public runtime::Object<AtomicReference> {
+public:
+    explicit AtomicReference(runtime::Object<void> *object) : object(object) {}
+
+    void lock() {
+        while (flag_.test_and_set(std::memory_order_acquire)) {}
+    }
+    void unlock() {
+        flag_.clear(std::memory_order_release);
+    }
+
+    runtime::Object<void> *object;
+private:
+    std::atomic_flag flag_ = ATOMIC_FLAG_INIT;
+};
+
+extern "C" AtomicInteger* sAtomicIntegerNew(runtime::Integer value) {
+    return AtomicInteger::init(value);
+}
+
+extern "C" runtime::Integer sAtomicIntegerLoad(AtomicInteger *atomic, runtime::Enum order) {
+    return atomic->value.load(loadOrder(order));
+}
+
+extern "C" void sAtomicIntegerStore(AtomicInteger *atomic, runtime::Integer value, runtime::Enum order) {
+    atomic->value.store(value, storeOrder(order));
+}
+
+extern "C" runtime::Integer sAtomicIntegerExchange(AtomicInteger *atomic, runtime::Integer value,
+                                                   runtime::Enum order) {
+    return atomic->value.exchange(value, memoryOrder(order));
+}
+
+extern "C" runtime::Integer sAtomicIntegerFetchAdd(AtomicInteger *atomic, runtime::Integer value,
+                                                   runtime::Enum order) {
+    return atomic->value.fetch_add(value, memoryOrder(order));
+}
+
+extern "C" runtime::Integer sAtomicIntegerFetchSub(AtomicInteger *atomic, runtime::Integer value,
+                                                   runtime::Enum order) {
+    return atomic->value.fetch_sub(value, memoryOrder(order));
+}
+
+extern "C" runtime::Boolean sAtomicIntegerCompareExchange(AtomicInteger *atomic, runtime::Integer expected,
+                                                          runtime::Integer desired, runtime::Enum order) {
+    return atomic->value.compare_exchange_strong(expected, desired, memoryOrder(order));
+}
+
+extern "C" void sAtomicIntegerDestruct(AtomicInteger *atomic) {
+    atomic->~AtomicInteger();
+}
+
+extern "C" AtomicBoolean* sAtomicBooleanNew(runtime::Boolean value) {
+    return AtomicBoolean::init(value);
+}
+
+extern "C" runtime::Boolean sAtomicBooleanLoad(AtomicBoolean *atomic, runtime::Enum order) {
+    return atomic->value.load(loadOrder(order));
+}
+
+extern "C" void sAtomicBooleanStore(AtomicBoolean *atomic, runtime::Boolean value, runtime::Enum order) {
+    atomic->value.store(value, storeOrder(order));
+}
+
+extern "C" runtime::Boolean sAtomicBooleanExchange(AtomicBoolean *atomic, runtime::Boolean value,
+                                                   runtime::Enum order) {
+    return atomic->value.exchange(value, memoryOrder(order));
+}
+
+extern "C" runtime::Boolean sAtomicBooleanCompareExchange(AtomicBoolean *atomic, runtime::Boolean expected,
+                                                          runtime::Boolean desired, runtime::Enum order) {
+    bool value = expected;
+    return atomic->value.compare_exchange_strong(value, desired, memoryOrder(order));
+}
+
+extern "C" void sAtomicBooleanDestruct(AtomicBoolean *atomic) {
+    atomic->~AtomicBoolean();
+}
+
+extern "C" AtomicReference* sAtomicReferenceNew(runtime::Object<void> *object) {
+    if (object != nullptr) {
+        object->retain();
+    }
+    return AtomicReference::init(object);
+}
+
+extern "C" runtime::Object<void>* sAtomicReferenceLoad(AtomicReference *atomic) {
+    atomic->lock();
+    auto object = atomic->object;
+    if (object != nullptr) {
+        object->retain();
+    }
+    atomic->unlock();
+    return object;
+}
+
+extern "C" runtime::Object<void>* sAtomicReferenceExchange(AtomicReference *atomic, runtime::Object<void> *object) {
+    if (object != nullptr) {
+        object->retain();
+    }
+    atomic->lock();
+    auto old = atomic->object;
+    atomic->object = object;
+    atomic->unlock();
+    return old;
+}
+
+extern "C" void sAtomicReferenceStore(AtomicReference *atomic, runtime::Object<void> *object) {
+    auto old = sAtomicReferenceExchange(atomic, object);
+    if (old != nullptr) {
+        old->release();
+    }
+}
+
+extern "C" runtime::Boolean sAtomicReferenceCompareExchange(AtomicReference *atomic, runtime::Object<void> *expected,
+                                                            runtime::Object<void> *desired) {
+    if (desired != nullptr) {
+        desired->retain();
+    }
+    atomic->lock();
+    auto success = atomic->object == expected;
+    if (success) {
+        atomic->object = desired;
+    }
+    atomic->unlock();
+
+    auto unused = success ? expected : desired;
+    if (unused != nullptr) {
+        unused->release();
+    }
+    return success;
+}
+
+extern "C" void sAtomicReferenceDestruct(AtomicReference *atomic) {
+    if (atomic->object != nullptr) {
+        atomic->object->release();
+    }
+    atomic->~AtomicReference();
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::AtomicInteger, s, 1f4ca)
+SET_INFO_FOR(s::AtomicBoolean, s, 1f6a9)
+SET_INFO_FOR(s::AtomicReference, s, 1f4ce)
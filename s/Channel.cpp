@@ -0,0 +1,209 @@
+//
+//  Channel.cpp
+//  Emojicode
+//
+
+#include "../runtime/Runtime.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace s {
+
+/// The slot bookkeeping of a 📨. This is a bounded multi-producer multi-consumer queue as described by Dmitry Vyukov.
+/// Every slot carries a sequence number that tells producers and consumers whether it may be written or read. The
+/// values themselves are stored in a 🧠 owned by the 📨, which writes them between reserving and publishing a slot.
+class ChannelSlots : public runtime::Object<ChannelSlots> {
+public:
+    /// Returned instead of a position if the operation timed out.
+    static constexpr runtime::Integer kTimedOut = -1;
+    /// Returned instead of a position if the channel was closed.
+    static constexpr runtime::Integer kClosed = -2;
+
+    explicit ChannelSlots(size_t capacity) : capacity_(capacity), sequences_(new std::atomic<size_t>[capacity]) {
+        for (size_t i = 0; i < capacity; i++) {
+            sequences_[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Reserves a slot for writing and returns its position or one of the constants above. A negative *timeout*
+    /// blocks until a slot becomes available, otherwise waits at most *timeout* microseconds.
+    runtime::Integer reserveSend(runtime::Integer timeout) {
+        return wait(timeout, sendWaiters_, sendCondition_, [this]() -> runtime::Integer {
+            if (closed_.load(std::memory_order_acquire)) {
+                return kClosed;
+            }
+            return tryReserve(enqueuePosition_, 0);
+        });
+    }
+
+    /// Makes the value written to the slot at *position* visible to receivers.
+    void publish(size_t position) {
+        sequences_[position % capacity_].store(position + 1, std::memory_order_release);
+        wake(receiveWaiters_, receiveCondition_);
+    }
+
+    /// Reserves a slot for reading and returns its position or one of the constants above. kClosed is only
+    /// returned once the channel was closed and all values sent before have been received.
+    runtime::Integer reserveReceive(runtime::Integer timeout) {
+        return wait(timeout, receiveWaiters_, receiveCondition_, [this]() -> runtime::Integer {
+            auto closed = closed_.load(std::memory_order_acquire);
+            auto position = tryReserve(dequeuePosition_, 1);
+            if (position == kTimedOut && closed &&
+                enqueuePosition_.load(std::memory_order_acquire) == dequeuePosition_.load(std::memory_order_acquire)) {
+                return kClosed;
+            }
+            return position;
+        });
+    }
+
+    /// Hands the slot at *position*, whose value was read, back to senders.
+    void recycle(size_t position) {
+        sequences_[position % capacity_].store(position + capacity_, std::memory_order_release);
+        wake(sendWaiters_, sendCondition_);
+    }
+
+    void close() {
+        closed_.store(true, std::memory_order_seq_cst);
+        std::lock_guard<std::mutex> lock(mutex_);
+        sendCondition_.notify_all();
+        receiveCondition_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+    size_t capacity() const { return capacity_; }
+    size_t first() const { return dequeuePosition_.load(std::memory_order_acquire); }
+    /// Returns the number of values in the channel. The dequeue position is loaded first: it never overtakes the
+    /// enqueue position loaded afterwards, but a concurrent receive may move it past an older enqueue position.
+    size_t count() const {
+        auto dequeue = dequeuePosition_.load(std::memory_order_acquire);
+        auto enqueue = enqueuePosition_.load(std::memory_order_acquire);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+private:
+    /// Attempts to advance *cursor*. A slot is ready if its sequence number equals the cursor plus *lag*.
+    runtime::Integer tryReserve(std::atomic<size_t> &cursor, size_t lag) {
+        auto position = cursor.load(std::memory_order_relaxed);
+        while (true) {
+            auto sequence = sequences_[position % capacity_].load(std::memory_order_acquire);
+            auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + lag);
+            if (difference == 0) {
+                if (cursor.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return static_cast<runtime::Integer>(position);
+                }
+            }
+            else if (difference < 0) {
+                return kTimedOut;
+            }
+            else {
+                position = cursor.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Calls *attempt* until it succeeds or the timeout expires. Spins briefly before blocking so that a busy
+    /// channel never touches the mutex.
+    template <typename Attempt>
+    runtime::Integer wait(runtime::Integer timeout, std::atomic<int> &waiters, std::condition_variable &condition,
+                          Attempt attempt) {
+        for (int i = 0; i < 64; i++) {
+            auto result = attempt();
+            if (result != kTimedOut || timeout == 0) {
+                return result;
+            }
+            std::this_thread::yield();
+        }
+
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::microseconds(std::max<runtime::Integer>(timeout, 0));
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::unique_lock<std::mutex> lock(mutex_);
+        runtime::Integer result;
+        while ((result = attempt()) == kTimedOut) {
+            if (timeout < 0) {
+                condition.wait(lock);
+            }
+            else if (condition.wait_until(lock, deadline) == std::cv_status::timeout) {
+                result = attempt();
+                break;
+            }
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    void wake(std::atomic<int> &waiters, std::condition_variable &condition) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_seq_cst) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+            condition.notify_all();
+        }
+    }
+
+    const size_t capacity_;
+    std::unique_ptr<std::atomic<size_t>[]> sequences_;
+    std::atomic<size_t> enqueuePosition_{0};
+    std::atomic<size_t> dequeuePosition_{0};
+    std::atomic<bool> closed_{false};
+    std::atomic<int> sendWaiters_{0};
+    std::atomic<int> receiveWaiters_{0};
+    std::mutex mutex_;
+    std::condition_variable sendCondition_;
+    std::condition_variable receiveCondition_;
+};
+
+extern "C" ChannelSlots* sChannelSlotsNew(runtime::Integer capacity) {
+    return ChannelSlots::init(static_cast<size_t>(std::max<runtime::Integer>(capacity, 1)));
+}
+
+extern "C" runtime::Integer sChannelSlotsReserveSend(ChannelSlots *slots, runtime::Integer timeout) {
+    return slots->reserveSend(timeout);
+}
+
+extern "C" void sChannelSlotsPublish(ChannelSlots *slots, runtime::Integer position) {
+    slots->publish(static_cast<size_t>(position));
+}
+
+extern "C" runtime::Integer sChannelSlotsReserveReceive(ChannelSlots *slots, runtime::Integer timeout) {
+    return slots->reserveReceive(timeout);
+}
+
+extern "C" void sChannelSlotsRecycle(ChannelSlots *slots, runtime::Integer position) {
+    slots->recycle(static_cast<size_t>(position));
+}
+
+extern "C" void sChannelSlotsClose(ChannelSlots *slots) {
+    slots->close();
+}
+
+extern "C" runtime::Boolean sChannelSlotsClosed(ChannelSlots *slots) {
+    return slots->closed();
+}
+
+extern "C" runtime::Integer sChannelSlotsCapacity(ChannelSlots *slots) {
+    return static_cast<runtime::Integer>(slots->capacity());
+}
+
+extern "C" runtime::Integer sChannelSlotsFirst(ChannelSlots *slots) {
+    return static_cast<runtime::Integer>(slots->first());
+}
+
+extern "C" runtime::Integer sChannelSlotsCount(ChannelSlots *slots) {
+    return static_cast<runtime::Integer>(slots->count());
+}
+
+extern "C" void sChannelSlotsDestruct(ChannelSlots *slots) {
+    slots->~ChannelSlots();
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::ChannelSlots, s, 1f4ed)
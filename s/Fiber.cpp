@@ -0,0 +1,376 @@
+//
+//  Fiber.cpp
+//  Emojicode
+//
+
+#include "Fiber.h"
+#include "TimerWheel.h"
+#include "../runtime/Runtime.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+namespace s {
+
+class Fiber : public runtime::Object<Fiber> {
+public:
+    explicit Fiber(runtime::Callable<void> callable) : callable(callable) {
+        deadline.context = this;
+    }
+
+    ~Fiber() {
+        if (stack != nullptr) {
+            munmap(stack, kStackSize);
+        }
+    }
+
+    /// The size of the stack of a 🌿. The memory is only committed once it is used.
+    static constexpr size_t kStackSize = 1 << 20;
+
+    runtime::Callable<void> callable;
+    ucontext_t context{};
+    void *stack = nullptr;
+    /// Run by the worker once it has switched away from this fiber, i.e. when it is safe to resume the fiber on
+    /// another worker.
+    std::function<void()> afterSwitch;
+    /// The descriptor this fiber waits for. Only accessed by the poller and with its lock held.
+    int descriptor = -1;
+    /// Set while the fiber waits for its descriptor. Only accessed by the poller and with its lock held.
+    bool waiting = false;
+    /// Wakes the fiber if the descriptor does not become ready in time.
+    TimerEntry deadline;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool done = false;
+    std::vector<Fiber *> joiners;
+};
+
+struct FiberWorker {
+    ucontext_t context{};
+    Fiber *current = nullptr;
+};
+
+thread_local FiberWorker fiberWorker;
+
+/// Returns the worker state of the calling OS thread. A fiber may continue on another OS thread after it was
+/// suspended, so code running on a fiber must not cache the address of a thread_local across a suspension.
+__attribute__((noinline)) FiberWorker* currentFiberWorker() {
+    return &fiberWorker;
+}
+
+/// Runs 🌿 on a few worker threads. A 🌿 that waits for a descriptor is handed to the poller, which puts it back
+/// into the run queue once the descriptor is ready or the wait timed out. The poller keeps the deadlines in a
+/// TimerWheel with a tick of one millisecond.
+class FiberScheduler {
+public:
+    static FiberScheduler& shared() {
+        static auto scheduler = new FiberScheduler();
+        return *scheduler;
+    }
+
+    void schedule(Fiber *fiber) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(fiber);
+        }
+        condition_.notify_one();
+    }
+
+    /// Switches from *fiber*, which must be the calling fiber, back to the worker, which then calls *afterSwitch*.
+    void suspend(Fiber *fiber, std::function<void()> afterSwitch) {
+        fiber->afterSwitch = std::move(afterSwitch);
+        swapcontext(&fiber->context, &currentFiberWorker()->context);
+    }
+
+    /// Registers *fiber* to be scheduled once *fd* is ready for *events*, which is either EPOLLIN or EPOLLOUT, or,
+    /// unless *timeout* is negative, after *timeout* microseconds. Must be called after switching away from *fiber*.
+    void wake(Fiber *fiber, int fd, uint32_t events, int64_t timeout) {
+        std::lock_guard<std::mutex> lock(pollMutex_);
+        auto &waiters = waiters_[fd];
+        auto registered = waiters.events() != 0;
+        (events == EPOLLIN ? waiters.readers : waiters.writers).push_back(fiber);
+        if (!arm(fd, waiters, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD)) {
+            // The descriptor cannot be polled, e.g. because it is a regular file, and never blocks.
+            waiters_.erase(fd);
+            schedule(fiber);
+            return;
+        }
+        fiber->descriptor = fd;
+        fiber->waiting = true;
+        if (timeout >= 0) {
+            auto previous = wheel_.next();
+            wheel_.schedule(&fiber->deadline, now() + static_cast<uint64_t>((timeout + 999) / 1000));
+            if (wheel_.next() < previous) {
+                uint64_t one = 1;
+                write(interrupt_, &one, sizeof(one));
+            }
+        }
+    }
+
+private:
+    /// The fibers waiting for a descriptor. The descriptor is registered with the events of all of them, so that any
+    /// number of fibers can wait for the same descriptor.
+    struct Waiters {
+        std::vector<Fiber *> readers;
+        std::vector<Fiber *> writers;
+
+        uint32_t events() const {
+            return (readers.empty() ? 0 : EPOLLIN) | (writers.empty() ? 0 : EPOLLOUT);
+        }
+    };
+
+    bool arm(int fd, const Waiters &waiters, int operation) {
+        struct epoll_event event{};
+        event.events = waiters.events() | EPOLLONESHOT;
+        event.data.fd = fd;
+        return epoll_ctl(epoll_, operation, fd, &event) == 0;
+    }
+
+    FiberScheduler() : epoll_(epoll_create1(EPOLL_CLOEXEC)), interrupt_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+                       start_(std::chrono::steady_clock::now()) {
+        struct epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = interrupt_;
+        epoll_ctl(epoll_, EPOLL_CTL_ADD, interrupt_, &event);
+
+        auto count = std::max(std::thread::hardware_concurrency(), 1u);
+        for (unsigned int i = 0; i < count; i++) {
+            std::thread([this]() { work(); }).detach();
+        }
+        std::thread([this]() { poll(); }).detach();
+    }
+
+    void work() {
+        auto &worker = fiberWorker;
+        while (true) {
+            Fiber *fiber;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this]() { return !queue_.empty(); });
+                fiber = queue_.front();
+                queue_.pop_front();
+            }
+            worker.current = fiber;
+            swapcontext(&worker.context, &fiber->context);
+            worker.current = nullptr;
+            auto afterSwitch = std::move(fiber->afterSwitch);
+            fiber->afterSwitch = nullptr;
+            if (afterSwitch) {
+                afterSwitch();
+            }
+        }
+    }
+
+    uint64_t now() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_).count());
+    }
+
+    void poll() {
+        struct epoll_event events[64];
+        std::vector<TimerEntry *> expired;
+        while (true) {
+            int timeout = -1;
+            {
+                std::lock_guard<std::mutex> lock(pollMutex_);
+                auto next = wheel_.next();
+                if (next != TimerWheel::kNever) {
+                    auto now = this->now();
+                    timeout = next > now ? static_cast<int>(std::min<uint64_t>(next - now, INT32_MAX)) : 0;
+                }
+            }
+
+            auto count = epoll_wait(epoll_, events, 64, timeout);
+
+            std::lock_guard<std::mutex> lock(pollMutex_);
+            for (int i = 0; i < count; i++) {
+                auto fd = events[i].data.fd;
+                if (fd == interrupt_) {
+                    uint64_t value;
+                    read(interrupt_, &value, sizeof(value));
+                    continue;
+                }
+                auto it = waiters_.find(fd);
+                if (it == waiters_.end()) {
+                    continue;
+                }
+                auto ready = events[i].events;
+                auto &waiters = it->second;
+                if ((ready & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) {
+                    resume(waiters.readers);
+                }
+                if ((ready & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0) {
+                    resume(waiters.writers);
+                }
+                update(it);
+            }
+            wheel_.advance(now(), expired);
+            for (auto entry : expired) {
+                timeOut(static_cast<Fiber *>(entry->context));
+            }
+            expired.clear();
+        }
+    }
+
+    /// Schedules all fibers in *fibers* and clears it. Must be called with pollMutex_ held.
+    void resume(std::vector<Fiber *> &fibers) {
+        for (auto fiber : fibers) {
+            fiber->waiting = false;
+            wheel_.cancel(&fiber->deadline);
+            schedule(fiber);
+        }
+        fibers.clear();
+    }
+
+    /// Removes *fiber*, whose deadline expired, from the waiters of its descriptor and schedules it. Must be called
+    /// with pollMutex_ held.
+    void timeOut(Fiber *fiber) {
+        if (!fiber->waiting) {
+            return;
+        }
+        fiber->waiting = false;
+        auto it = waiters_.find(fiber->descriptor);
+        if (it != waiters_.end()) {
+            auto &readers = it->second.readers;
+            auto &writers = it->second.writers;
+            readers.erase(std::remove(readers.begin(), readers.end(), fiber), readers.end());
+            writers.erase(std::remove(writers.begin(), writers.end(), fiber), writers.end());
+            update(it);
+        }
+        schedule(fiber);
+    }
+
+    /// Stops polling the descriptor of *it* if no fiber waits for it anymore, or rearms the one-shot registration
+    /// for the fibers that are still waiting. Must be called with pollMutex_ held.
+    void update(std::unordered_map<int, Waiters>::iterator it) {
+        if (it->second.events() == 0) {
+            epoll_ctl(epoll_, EPOLL_CTL_DEL, it->first, nullptr);
+            waiters_.erase(it);
+        }
+        else {
+            arm(it->first, it->second, EPOLL_CTL_MOD);
+        }
+    }
+
+    int epoll_;
+    /// An eventfd to interrupt the poller when a deadline earlier than all others was added.
+    int interrupt_;
+    const std::chrono::steady_clock::time_point start_;
+    std::unordered_map<int, Waiters> waiters_;
+    TimerWheel wheel_;
+    std::mutex pollMutex_;
+    std::deque<Fiber *> queue_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+void fiberMain() {
+    auto fiber = currentFiberWorker()->current;
+    fiber->callable();
+    fiber->callable.release();
+
+    std::vector<Fiber *> joiners;
+    {
+        std::lock_guard<std::mutex> lock(fiber->mutex);
+        fiber->done = true;
+        joiners.swap(fiber->joiners);
+    }
+    fiber->condition.notify_all();
+    for (auto joiner : joiners) {
+        FiberScheduler::shared().schedule(joiner);
+    }
+    FiberScheduler::shared().suspend(fiber, [fiber]() { fiber->release(); });
+}
+
+namespace fiber {
+
+bool active() {
+    return currentFiberWorker()->current != nullptr;
+}
+
+void waitReadable(int fd, int64_t timeout) {
+    auto self = currentFiberWorker()->current;
+    FiberScheduler::shared().suspend(self, [self, fd, timeout]() {
+        FiberScheduler::shared().wake(self, fd, EPOLLIN, timeout);
+    });
+}
+
+void waitWritable(int fd, int64_t timeout) {
+    auto self = currentFiberWorker()->current;
+    FiberScheduler::shared().suspend(self, [self, fd, timeout]() {
+        FiberScheduler::shared().wake(self, fd, EPOLLOUT, timeout);
+    });
+}
+
+}  // namespace fiber
+
+extern "C" Fiber* sFiberNew(runtime::Callable<void> callable) {
+    auto fiber = Fiber::init(callable);
+    auto stack = mmap(nullptr, Fiber::kStackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                      -1, 0);
+    if (stack == MAP_FAILED) {
+        ejcPanic("Could not allocate the stack of a 🌿.");
+    }
+    // Guard page to turn a stack overflow into a crash instead of memory corruption.
+    mprotect(stack, static_cast<size_t>(sysconf(_SC_PAGESIZE)), PROT_NONE);
+    fiber->stack = stack;
+
+    getcontext(&fiber->context);
+    fiber->context.uc_stack.ss_sp = stack;
+    fiber->context.uc_stack.ss_size = Fiber::kStackSize;
+    fiber->context.uc_link = nullptr;
+    makecontext(&fiber->context, fiberMain, 0);
+
+    callable.retain();
+    fiber->retain();
+    FiberScheduler::shared().schedule(fiber);
+    return fiber;
+}
+
+extern "C" void sFiberJoin(Fiber *fiber) {
+    std::unique_lock<std::mutex> lock(fiber->mutex);
+    if (fiber->done) {
+        return;
+    }
+    if (fiber::active()) {
+        auto self = currentFiberWorker()->current;
+        fiber->joiners.push_back(self);
+        lock.release();
+        FiberScheduler::shared().suspend(self, [fiber]() { fiber->mutex.unlock(); });
+        return;
+    }
+    fiber->condition.wait(lock, [fiber]() { return fiber->done; });
+}
+
+extern "C" void sFiberYield(runtime::ClassInfo *) {
+    if (!fiber::active()) {
+        std::this_thread::yield();
+        return;
+    }
+    auto self = currentFiberWorker()->current;
+    FiberScheduler::shared().suspend(self, [self]() { FiberScheduler::shared().schedule(self); });
+}
+
+extern "C" runtime::Boolean sFiberActive(runtime::ClassInfo *) {
+    return fiber::active();
+}
+
+extern "C" void sFiberDestruct(Fiber *fiber) {
+    fiber->~Fiber();
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::Fiber, s, 1f33f)
@@ -0,0 +1,28 @@
+//
+//  Fiber.h
+//  Emojicode
+//
+
+#ifndef EMOJICODE_FIBER_H
+#define EMOJICODE_FIBER_H
+
+#include <cstdint>
+
+namespace s {
+namespace fiber {
+
+/// Returns true if the calling code runs on a 🌿.
+bool active();
+
+/// Suspends the calling 🌿 until *fd* is ready for reading or, unless *timeout* is negative, *timeout* microseconds
+/// have passed. The 🌿 may also be resumed spuriously, so callers must retry the operation and check for the
+/// timeout themselves. Must only be called if active() returns true.
+void waitReadable(int fd, int64_t timeout = -1);
+
+/// Like waitReadable() but waits until *fd* is ready for writing.
+void waitWritable(int fd, int64_t timeout = -1);
+
+}  // namespace fiber
+}  // namespace s
+
+#endif //EMOJICODE_FIBER_H
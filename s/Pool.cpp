@@ -0,0 +1,359 @@
+//
+//  Pool.cpp
+//  Emojicode
+//
+
+#include "../runtime/Runtime.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s {
+
+class Ticket : public runtime::Object<Ticket> {
+public:
+    void complete() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.store(true, std::memory_order_release);
+        }
+        condition.notify_all();
+    }
+
+    std::atomic<bool> done{false};
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+struct Task {
+    Task(runtime::Callable<void> callable, Ticket *ticket) : callable(callable), ticket(ticket) {}
+
+    runtime::Callable<void> callable;
+    Ticket *ticket;
+};
+
+/// A Chase-Lev work-stealing deque. Only the owning worker calls push() and pop(), all other threads may call steal().
+class WorkStealingDeque {
+public:
+    WorkStealingDeque() : array_(new Array(64)) {
+        arrays_.emplace_back(array_.load(std::memory_order_relaxed));
+    }
+
+    void push(Task *task) {
+        auto bottom = bottom_.load(std::memory_order_relaxed);
+        auto top = top_.load(std::memory_order_acquire);
+        auto array = array_.load(std::memory_order_relaxed);
+        if (bottom - top > array->capacity - 1) {
+            array = grow(array, top, bottom);
+        }
+        array->put(bottom, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    Task* pop() {
+        auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        auto array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        auto task = array->get(bottom);
+        if (top == bottom) {
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    Task* steal() {
+        auto top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        auto task = array_.load(std::memory_order_acquire)->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return task;
+    }
+
+private:
+    struct Array {
+        explicit Array(int64_t capacity) : capacity(capacity), slots(new std::atomic<Task*>[capacity]) {}
+
+        Task* get(int64_t index) const {
+            return slots[index & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+        void put(int64_t index, Task *task) {
+            slots[index & (capacity - 1)].store(task, std::memory_order_relaxed);
+        }
+
+        const int64_t capacity;
+        std::unique_ptr<std::atomic<Task*>[]> slots;
+    };
+
+    /// Replaces the array with one of twice the capacity. The old array is kept alive as thieves might still read
+    /// from it.
+    Array* grow(Array *array, int64_t top, int64_t bottom) {
+        auto newArray = new Array(array->capacity * 2);
+        for (auto i = top; i < bottom; i++) {
+            newArray->put(i, array->get(i));
+        }
+        arrays_.emplace_back(newArray);
+        array_.store(newArray, std::memory_order_release);
+        return newArray;
+    }
+
+    std::atomic<int64_t> top_{0};
+    std::atomic<int64_t> bottom_{0};
+    std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+class Scheduler;
+
+struct Worker {
+    Worker(Scheduler *scheduler, size_t index) : scheduler(scheduler), index(index) {}
+
+    Scheduler *scheduler;
+    size_t index;
+    WorkStealingDeque deque;
+    std::thread thread;
+};
+
+thread_local Worker *currentWorker = nullptr;
+
+/// Runs the tasks of a 🏭. The scheduler is shared between the pool object and its workers so that a pool released
+/// on one of its own workers can still shut down safely.
+class Scheduler : public std::enable_shared_from_this<Scheduler> {
+public:
+    explicit Scheduler(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            workers_.emplace_back(std::make_unique<Worker>(this, i));
+        }
+    }
+
+    void start() {
+        auto self = shared_from_this();
+        for (auto &worker : workers_) {
+            auto workerPtr = worker.get();
+            worker->thread = std::thread([self, workerPtr]() {
+                currentWorker = workerPtr;
+                self->work(workerPtr);
+            });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        condition_.notify_all();
+
+        bool onWorker = currentWorker != nullptr && currentWorker->scheduler == this;
+        for (auto &worker : workers_) {
+            if (onWorker) {
+                worker->thread.detach();
+            }
+            else {
+                worker->thread.join();
+            }
+        }
+    }
+
+    /// Schedules a task. Tasks submitted from one of the workers are pushed onto its own deque, all other tasks are
+    /// placed in the shared queue.
+    void submit(Task *task) {
+        unfinished_.fetch_add(1, std::memory_order_relaxed);
+        if (currentWorker != nullptr && currentWorker->scheduler == this) {
+            currentWorker->deque.push(task);
+            pending_.fetch_add(1, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+        }
+        else {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(task);
+            pending_.fetch_add(1, std::memory_order_release);
+        }
+        condition_.notify_one();
+    }
+
+    /// Returns a task that is ready to run or nullptr if no task was found.
+    Task* find(Worker *worker) {
+        Task *task = nullptr;
+        if (worker != nullptr) {
+            task = worker->deque.pop();
+        }
+        if (task == nullptr && pending_.load(std::memory_order_acquire) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!queue_.empty()) {
+                    task = queue_.front();
+                    queue_.pop_front();
+                }
+            }
+            auto start = worker != nullptr ? worker->index + 1 : 0;
+            for (size_t i = 0; task == nullptr && i < workers_.size(); i++) {
+                auto victim = workers_[(start + i) % workers_.size()].get();
+                if (victim != worker) {
+                    task = victim->deque.steal();
+                }
+            }
+        }
+        if (task != nullptr) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    void run(Task *task) {
+        task->callable();
+        task->callable.release();
+        task->ticket->complete();
+        task->ticket->release();
+        delete task;
+        if (unfinished_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+            idle_.notify_all();
+        }
+    }
+
+    /// Runs other tasks until *done* returns true if called on a worker of this scheduler. Otherwise waits on
+    /// *condition* protected by *mutex*.
+    template <typename Predicate>
+    void helpUntil(Predicate done, std::mutex &mutex, std::condition_variable &condition) {
+        if (currentWorker != nullptr && currentWorker->scheduler == this) {
+            while (!done()) {
+                if (auto task = find(currentWorker)) {
+                    run(task);
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, done);
+    }
+
+    void join() {
+        if (currentWorker != nullptr && currentWorker->scheduler == this) {
+            ejcPanic("🏭🛂 was called from a task running on the same pool.");
+        }
+        helpUntil([this]() { return unfinished_.load(std::memory_order_acquire) == 0; }, mutex_, idle_);
+    }
+
+    size_t count() const { return workers_.size(); }
+
+private:
+    void work(Worker *worker) {
+        while (true) {
+            if (auto task = find(worker)) {
+                run(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this]() { return stopping_ || pending_.load(std::memory_order_acquire) > 0; });
+            if (stopping_ && pending_.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::deque<Task *> queue_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::condition_variable idle_;
+    /// The number of tasks that were submitted but not yet taken by a worker.
+    std::atomic<int64_t> pending_{0};
+    /// The number of tasks that were submitted but have not completed yet.
+    std::atomic<int64_t> unfinished_{0};
+    bool stopping_ = false;
+};
+
+class Pool : public runtime::Object<Pool> {
+public:
+    explicit Pool(size_t count) : scheduler(std::make_shared<Scheduler>(count)) {
+        scheduler->start();
+    }
+
+    std::shared_ptr<Scheduler> scheduler;
+};
+
+extern "C" Pool* sPoolNew(runtime::Integer workers) {
+    return Pool::init(static_cast<size_t>(std::max<runtime::Integer>(workers, 1)));
+}
+
+extern "C" Pool* sPoolShared(runtime::ClassInfo *) {
+    static Pool *shared = Pool::init(std::max(std::thread::hardware_concurrency(), 1u));
+    shared->retain();
+    return shared;
+}
+
+extern "C" runtime::Integer sPoolCount(Pool *pool) {
+    return static_cast<runtime::Integer>(pool->scheduler->count());
+}
+
+extern "C" Ticket* sPoolSubmit(Pool *pool, runtime::Callable<void> callable) {
+    auto ticket = Ticket::init();
+    callable.retain();
+    ticket->retain();
+    pool->scheduler->submit(new Task(callable, ticket));
+    return ticket;
+}
+
+extern "C" void sPoolJoin(Pool *pool) {
+    pool->scheduler->join();
+}
+
+extern "C" void sPoolDestruct(Pool *pool) {
+    pool->scheduler->stop();
+    pool->~Pool();
+}
+
+extern "C" void sTicketAwait(Ticket *ticket) {
+    auto done = [ticket]() { return ticket->done.load(std::memory_order_acquire); };
+    if (done()) {
+        return;
+    }
+    if (currentWorker != nullptr) {
+        currentWorker->scheduler->helpUntil(done, ticket->mutex, ticket->condition);
+        return;
+    }
+    std::unique_lock<std::mutex> lock(ticket->mutex);
+    ticket->condition.wait(lock, done);
+}
+
+extern "C" runtime::Boolean sTicketDone(Ticket *ticket) {
+    return ticket->done.load(std::memory_order_acquire);
+}
+
+extern "C" void sTicketDestruct(Ticket *ticket) {
+    ticket->~Ticket();
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::Pool, s, 1f3ed)
+SET_INFO_FOR(s::Ticket, s, 1f3ab)
@@ -9,6 +9,7 @@
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 
 extern "C" double sRealSin(double *real) {
     return std::sin(*real);
@@ -37,3 +38,14 @@ extern "C" double sRealATan(double *real) {
 extern "C" double sRealSqrt(double *real) {
     return std::sqrt(*real);
 }
+
+extern "C" int64_t sRealHash(double *real) {
+    uint64_t bits;
+    std::memcpy(&bits, real, sizeof(bits));
+    // 0.0 and -0.0 are equal and must therefore hash equally. The bits are compared as the build allows the compiler
+    // to ignore the sign of zero.
+    if (bits << 1 == 0) {
+        bits = 0;
+    }
+    return static_cast<int64_t>(bits);
+}
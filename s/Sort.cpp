@@ -0,0 +1,101 @@
+//
+//  Sort.cpp
+//  EmojicodeCompiler
+//
+//  Native sorting of primitive values stored in 🧠, used by the 🦁 type methods of 🔢, 💯 and 🔡.
+//
+
+#include "../runtime/Runtime.h"
+#include "String.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace s {
+
+/// Lists shorter than this are sorted with std::sort as the radix passes would not pay off.
+const runtime::Integer kRadixThreshold = 256;
+
+/// Sorts the unsigned 64-bit keys in ascending order using least significant digit radix sort. Passes over bytes
+/// that are equal in all keys are skipped.
+void radixSort(uint64_t *keys, runtime::Integer count) {
+    if (count < kRadixThreshold) {
+        std::sort(keys, keys + count);
+        return;
+    }
+
+    std::vector<uint64_t> buffer(count);
+    uint64_t *from = keys;
+    uint64_t *to = buffer.data();
+
+    size_t histograms[8][256] = {};
+    for (runtime::Integer i = 0; i < count; i++) {
+        for (size_t pass = 0; pass < 8; pass++) {
+            histograms[pass][(keys[i] >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    for (size_t pass = 0; pass < 8; pass++) {
+        auto &histogram = histograms[pass];
+        if (histogram[(keys[0] >> (pass * 8)) & 0xFF] == static_cast<size_t>(count)) {
+            continue;
+        }
+        size_t offset = 0;
+        for (auto &bucket : histogram) {
+            auto n = bucket;
+            bucket = offset;
+            offset += n;
+        }
+        for (runtime::Integer i = 0; i < count; i++) {
+            to[histogram[(from[i] >> (pass * 8)) & 0xFF]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+
+    if (from != keys) {
+        std::memcpy(keys, from, count * sizeof(uint64_t));
+    }
+}
+
+template <typename T>
+T* memoryData(int8_t **memory) {
+    return reinterpret_cast<T *>(*memory + sizeof(runtime::internal::ControlBlock*));
+}
+
+}  // namespace s
+
+extern "C" void sMemorySortIntegers(int8_t **memory, runtime::Integer count) {
+    auto keys = s::memoryData<uint64_t>(memory);
+    // Flipping the sign bit orders negative integers before positive ones.
+    for (runtime::Integer i = 0; i < count; i++) {
+        keys[i] ^= UINT64_C(1) << 63;
+    }
+    s::radixSort(keys, count);
+    for (runtime::Integer i = 0; i < count; i++) {
+        keys[i] ^= UINT64_C(1) << 63;
+    }
+}
+
+extern "C" void sMemorySortReals(int8_t **memory, runtime::Integer count) {
+    auto keys = s::memoryData<uint64_t>(memory);
+    // Maps the IEEE 754 representation to integers with the same order: Negative numbers are inverted entirely,
+    // positive numbers only get their sign bit set.
+    for (runtime::Integer i = 0; i < count; i++) {
+        keys[i] = (keys[i] >> 63) != 0 ? ~keys[i] : keys[i] | (UINT64_C(1) << 63);
+    }
+    s::radixSort(keys, count);
+    for (runtime::Integer i = 0; i < count; i++) {
+        keys[i] = (keys[i] >> 63) != 0 ? keys[i] & ~(UINT64_C(1) << 63) : ~keys[i];
+    }
+}
+
+extern "C" void sMemorySortStrings(int8_t **memory, runtime::Integer count) {
+    auto strings = s::memoryData<s::String *>(memory);
+    // Same order as 🔡↔️: Longer strings first, strings of equal length byte by byte.
+    std::sort(strings, strings + count, [](s::String *a, s::String *b) {
+        if (a->count != b->count) {
+            return a->count > b->count;
+        }
+        return std::memcmp(a->characters.get(), b->characters.get(), a->count) < 0;
+    });
+}
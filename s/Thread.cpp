@@ -3,8 +3,14 @@
 //
 
 #include "../runtime/Runtime.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace s {
 
@@ -13,11 +19,204 @@ public:
     std::thread thread;
 };
 
+/// The values of all 🎒 for one thread. The values are released when the thread exits.
+///
+/// Every table is registered in a global list, so that releasing a key can release the values every thread stored
+/// for it. The mutex of a table is therefore only ever contended while a key is being released.
+class ThreadLocals {
+public:
+    ThreadLocals() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(this);
+    }
+
+    ~ThreadLocals() {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            auto &tables = registry();
+            tables.erase(std::find(tables.begin(), tables.end(), this));
+        }
+        clear();
+    }
+
+    /// Returns the value stored for *key* at +1 or nullptr.
+    runtime::Object<void>* get(int64_t key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = values_.find(key);
+        if (it == values_.end()) {
+            return nullptr;
+        }
+        it->second->retain();
+        return it->second;
+    }
+
+    void set(int64_t key, runtime::Object<void> *object) {
+        object->retain();
+        runtime::Object<void> *old;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto &value = values_[key];
+            old = value;
+            value = object;
+        }
+        if (old != nullptr) {
+            old->release();
+        }
+    }
+
+    /// Releases all values. Deinitializers run by this method may store new values, which are released as well.
+    void clear() {
+        while (true) {
+            std::unordered_map<int64_t, runtime::Object<void>*> values;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (values_.empty()) {
+                    return;
+                }
+                values = std::move(values_);
+                values_.clear();
+            }
+            for (auto &pair : values) {
+                pair.second->release();
+            }
+        }
+    }
+
+    /// Releases the value every thread stored for *key*.
+    static void eraseEverywhere(int64_t key) {
+        std::vector<runtime::Object<void>*> values;
+        {
+            std::lock_guard<std::mutex> registryLock(registryMutex());
+            for (auto table : registry()) {
+                std::lock_guard<std::mutex> lock(table->mutex_);
+                auto it = table->values_.find(key);
+                if (it != table->values_.end()) {
+                    values.push_back(it->second);
+                    table->values_.erase(it);
+                }
+            }
+        }
+        for (auto value : values) {
+            value->release();
+        }
+    }
+
+private:
+    std::unordered_map<int64_t, runtime::Object<void>*> values_;
+    std::mutex mutex_;
+
+    /// The registry is never destroyed because threads may still exit after static destructors ran.
+    static std::vector<ThreadLocals*>& registry() {
+        static auto tables = new std::vector<ThreadLocals*>();
+        return *tables;
+    }
+
+    static std::mutex& registryMutex() {
+        static auto mutex = new std::mutex();
+        return *mutex;
+    }
+};
+
+thread_local ThreadLocals threadLocals;
+
+class ThreadLocalKey : public runtime::Object<ThreadLocalKey> {
+public:
+    ThreadLocalKey() : id(nextId_.fetch_add(1, std::memory_order_relaxed)) {}
+
+    /// Ids are never reused, so that a value left behind by a released key is never mistaken for the value of
+    /// another key.
+    const int64_t id;
+private:
+    static std::atomic<int64_t> nextId_;
+};
+
+std::atomic<int64_t> ThreadLocalKey::nextId_{0};
+
 class Mutex : public runtime::Object<Mutex> {
 public:
     std::mutex mutex;
 };
 
+class Condition : public runtime::Object<Condition> {
+public:
+    std::condition_variable condition;
+};
+
+/// A writer-preferring reader-writer lock. Readers only touch the atomic state unless a writer holds or waits for the
+/// lock, in which case they block until all waiting writers are done.
+class ReadWriteLock : public runtime::Object<ReadWriteLock> {
+public:
+    void lockRead() {
+        while (true) {
+            auto state = state_.load(std::memory_order_seq_cst);
+            if (readable(state)) {
+                if (state_.compare_exchange_weak(state, state + 1, std::memory_order_seq_cst)) {
+                    return;
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            readers_.wait(lock, [this]() { return readable(state_.load(std::memory_order_seq_cst)); });
+        }
+    }
+
+    void unlockRead() {
+        if (state_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+            writersWaiting_.load(std::memory_order_seq_cst) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+            writers_.notify_one();
+        }
+    }
+
+    void lockWrite() {
+        writersWaiting_.fetch_add(1, std::memory_order_seq_cst);
+        int64_t expected = 0;
+        if (!state_.compare_exchange_strong(expected, kWriter, std::memory_order_seq_cst)) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            writers_.wait(lock, [this]() {
+                int64_t expected = 0;
+                return state_.compare_exchange_strong(expected, kWriter, std::memory_order_seq_cst);
+            });
+        }
+        writersWaiting_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void unlockWrite() {
+        state_.store(0, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        if (writersWaiting_.load(std::memory_order_seq_cst) > 0) {
+            writers_.notify_one();
+        }
+        else {
+            readers_.notify_all();
+        }
+    }
+
+private:
+    static constexpr int64_t kWriter = int64_t(1) << 62;
+
+    bool readable(int64_t state) const {
+        return (state & kWriter) == 0 && writersWaiting_.load(std::memory_order_seq_cst) == 0;
+    }
+
+    /// The number of readers holding the lock or kWriter if a writer holds the lock.
+    std::atomic<int64_t> state_{0};
+    std::atomic<int64_t> writersWaiting_{0};
+    std::mutex mutex_;
+    std::condition_variable readers_;
+    std::condition_variable writers_;
+};
+
+class Once : public runtime::Object<Once> {
+public:
+    std::atomic<bool> done{false};
+    std::mutex mutex;
+};
+
 extern "C" Thread* sThreadNew(runtime::Callable<void> callable) {
     auto thread = Thread::init();
     callable.retain();
@@ -25,6 +224,7 @@ extern "C" Thread* sThreadNew(runtime::Callable<void> callable) {
     thread->thread = std::thread([thread, callable]() {
         callable();
         callable.release();
+        threadLocals.clear();
         thread->release();
     });
     return thread;
@@ -50,8 +250,8 @@ extern "C" void sMutexLock(Mutex *mutex) {
     mutex->mutex.lock();
 }
 
-extern "C" void sMutexTryLock(Mutex *mutex) {
-    mutex->mutex.try_lock();
+extern "C" runtime::Boolean sMutexTryLock(Mutex *mutex) {
+    return mutex->mutex.try_lock();
 }
 
 extern "C" void sMutexUnlock(Mutex *mutex) {
@@ -62,7 +262,104 @@ extern "C" void sMutexDestruct(Mutex *mutex) {
     mutex->~Mutex();
 }
 
+extern "C" Condition* sConditionNew() {
+    return Condition::init();
+}
+
+extern "C" void sConditionWait(Condition *condition, Mutex *mutex) {
+    std::unique_lock<std::mutex> lock(mutex->mutex, std::adopt_lock);
+    condition->condition.wait(lock);
+    lock.release();
+}
+
+extern "C" runtime::Boolean sConditionWaitFor(Condition *condition, Mutex *mutex, runtime::Integer mcs) {
+    std::unique_lock<std::mutex> lock(mutex->mutex, std::adopt_lock);
+    auto status = condition->condition.wait_for(lock, std::chrono::microseconds(mcs));
+    lock.release();
+    return status == std::cv_status::no_timeout;
+}
+
+extern "C" void sConditionNotifyOne(Condition *condition) {
+    condition->condition.notify_one();
+}
+
+extern "C" void sConditionNotifyAll(Condition *condition) {
+    condition->condition.notify_all();
+}
+
+extern "C" void sConditionDestruct(Condition *condition) {
+    condition->~Condition();
+}
+
+extern "C" ReadWriteLock* sReadWriteLockNew() {
+    return ReadWriteLock::init();
+}
+
+extern "C" void sReadWriteLockLockRead(ReadWriteLock *lock) {
+    lock->lockRead();
+}
+
+extern "C" void sReadWriteLockUnlockRead(ReadWriteLock *lock) {
+    lock->unlockRead();
+}
+
+extern "C" void sReadWriteLockLockWrite(ReadWriteLock *lock) {
+    lock->lockWrite();
+}
+
+extern "C" void sReadWriteLockUnlockWrite(ReadWriteLock *lock) {
+    lock->unlockWrite();
+}
+
+extern "C" void sReadWriteLockDestruct(ReadWriteLock *lock) {
+    lock->~ReadWriteLock();
+}
+
+extern "C" Once* sOnceNew() {
+    return Once::init();
+}
+
+extern "C" void sOnceCall(Once *once, runtime::Callable<void> callable) {
+    if (once->done.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(once->mutex);
+    if (!once->done.load(std::memory_order_relaxed)) {
+        callable();
+        once->done.store(true, std::memory_order_release);
+    }
+}
+
+extern "C" runtime::Boolean sOnceDone(Once *once) {
+    return once->done.load(std::memory_order_acquire);
+}
+
+extern "C" void sOnceDestruct(Once *once) {
+    once->~Once();
+}
+
+extern "C" ThreadLocalKey* sThreadLocalKeyNew() {
+    return ThreadLocalKey::init();
+}
+
+extern "C" runtime::Object<void>* sThreadLocalKeyGet(ThreadLocalKey *key) {
+    return threadLocals.get(key->id);
+}
+
+extern "C" void sThreadLocalKeySet(ThreadLocalKey *key, runtime::Object<void> *object) {
+    threadLocals.set(key->id, object);
+}
+
+extern "C" void sThreadLocalKeyDestruct(ThreadLocalKey *key) {
+    ThreadLocals::eraseEverywhere(key->id);
+    key->~ThreadLocalKey();
+}
+
 }  // namespace s
 
 SET_INFO_FOR(s::Thread, s, 1f9f5)
 SET_INFO_FOR(s::Mutex, s, 1f510)
+SET_INFO_FOR(s::Condition, s, 1f514)
+SET_INFO_FOR(s::ReadWriteLock, s, 1f453)
+SET_INFO_FOR(s::Once, s, 1f9e8)
+SET_INFO_FOR(s::ThreadLocalKey, s, 1f511)
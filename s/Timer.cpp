@@ -0,0 +1,168 @@
+//
+//  Timer.cpp
+//  Emojicode
+//
+
+#include "TimerWheel.h"
+#include "../runtime/Runtime.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s {
+
+class Timer : public runtime::Object<Timer> {
+public:
+    enum class State { Pending, Running, Done, Cancelled };
+
+    Timer(runtime::Callable<void> callable, uint64_t interval) : callable(callable), interval(interval) {
+        entry.context = this;
+    }
+
+    runtime::Callable<void> callable;
+    /// The number of ticks between two calls of a repeating timer or 0.
+    const uint64_t interval;
+    TimerEntry entry;
+    State state = State::Pending;
+};
+
+/// Calls the callbacks of all ⌛ on a single thread. A tick lasts one millisecond.
+class TimerService {
+public:
+    static TimerService& shared() {
+        static auto service = new TimerService();
+        return *service;
+    }
+
+    static uint64_t ticks(runtime::Integer microseconds) {
+        return microseconds <= 0 ? 0 : static_cast<uint64_t>((microseconds + 999) / 1000);
+    }
+
+    void schedule(Timer *timer, uint64_t delay) {
+        timer->retain();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wheel_.schedule(&timer->entry, now() + delay);
+        }
+        condition_.notify_one();
+    }
+
+    bool cancel(Timer *timer) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        switch (timer->state) {
+            case Timer::State::Pending:
+                wheel_.cancel(&timer->entry);
+                timer->state = Timer::State::Cancelled;
+                lock.unlock();
+                timer->release();
+                return true;
+            case Timer::State::Running:
+                timer->state = Timer::State::Cancelled;
+                return timer->interval > 0;
+            default:
+                return false;
+        }
+    }
+
+    bool pending(Timer *timer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timer->state == Timer::State::Pending || (timer->state == Timer::State::Running && timer->interval > 0);
+    }
+
+private:
+    TimerService() : start_(std::chrono::steady_clock::now()) {
+        std::thread([this]() { run(); }).detach();
+    }
+
+    uint64_t now() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_).count());
+    }
+
+    void run() {
+        std::vector<TimerEntry *> expired;
+        std::vector<Timer *> finished;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wheel_.advance(now(), expired);
+            if (!expired.empty()) {
+                for (auto entry : expired) {
+                    static_cast<Timer *>(entry->context)->state = Timer::State::Running;
+                }
+                lock.unlock();
+                for (auto entry : expired) {
+                    static_cast<Timer *>(entry->context)->callable();
+                }
+                lock.lock();
+                for (auto entry : expired) {
+                    auto timer = static_cast<Timer *>(entry->context);
+                    if (timer->state == Timer::State::Running && timer->interval > 0) {
+                        timer->state = Timer::State::Pending;
+                        wheel_.schedule(entry, now() + timer->interval);
+                        continue;
+                    }
+                    if (timer->state == Timer::State::Running) {
+                        timer->state = Timer::State::Done;
+                    }
+                    finished.push_back(timer);
+                }
+                expired.clear();
+                lock.unlock();
+                for (auto timer : finished) {
+                    timer->release();
+                }
+                finished.clear();
+                lock.lock();
+                continue;
+            }
+
+            auto next = wheel_.next();
+            if (next == TimerWheel::kNever) {
+                condition_.wait(lock);
+            }
+            else {
+                condition_.wait_until(lock, start_ + std::chrono::milliseconds(next));
+            }
+        }
+    }
+
+    const std::chrono::steady_clock::time_point start_;
+    TimerWheel wheel_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+extern "C" Timer* sTimerNew(runtime::Integer microseconds, runtime::Callable<void> callable) {
+    auto timer = Timer::init(callable, 0);
+    callable.retain();
+    TimerService::shared().schedule(timer, TimerService::ticks(microseconds));
+    return timer;
+}
+
+extern "C" Timer* sTimerNewRepeating(runtime::Integer microseconds, runtime::Callable<void> callable) {
+    auto interval = std::max<uint64_t>(TimerService::ticks(microseconds), 1);
+    auto timer = Timer::init(callable, interval);
+    callable.retain();
+    TimerService::shared().schedule(timer, interval);
+    return timer;
+}
+
+extern "C" runtime::Boolean sTimerCancel(Timer *timer) {
+    return TimerService::shared().cancel(timer);
+}
+
+extern "C" runtime::Boolean sTimerPending(Timer *timer) {
+    return TimerService::shared().pending(timer);
+}
+
+extern "C" void sTimerDestruct(Timer *timer) {
+    timer->callable.release();
+    timer->~Timer();
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::Timer, s, 231b)
@@ -0,0 +1,132 @@
+//
+//  TimerWheel.cpp
+//  Emojicode
+//
+
+#include "TimerWheel.h"
+#include <algorithm>
+
+namespace s {
+
+constexpr int TimerWheel::kLevels;
+constexpr int TimerWheel::kSlotBits;
+constexpr int TimerWheel::kSlots;
+constexpr uint64_t TimerWheel::kNever;
+
+void TimerWheel::schedule(TimerEntry *entry, uint64_t deadline) {
+    cancel(entry);
+    entry->deadline = std::max(deadline, now_ + 1);
+    place(entry);
+}
+
+void TimerWheel::cancel(TimerEntry *entry) {
+    if (entry->scheduled()) {
+        unlink(entry);
+    }
+}
+
+void TimerWheel::place(TimerEntry *entry) {
+    auto deadline = entry->deadline;
+    int level = 0;
+    while (level < kLevels && (deadline >> ((level + 1) * kSlotBits)) != (now_ >> ((level + 1) * kSlotBits))) {
+        level++;
+    }
+    auto slot = level == kLevels ? 0 : static_cast<int>((deadline >> (level * kSlotBits)) & (kSlots - 1));
+
+    auto &list = head(level, slot);
+    entry->level = level;
+    entry->slot = slot;
+    entry->previous = nullptr;
+    entry->next = list;
+    if (entry->next != nullptr) {
+        entry->next->previous = entry;
+    }
+    list = entry;
+    if (level < kLevels) {
+        occupied_[level] |= uint64_t(1) << slot;
+    }
+    count_++;
+}
+
+void TimerWheel::unlink(TimerEntry *entry) {
+    auto &list = head(entry->level, entry->slot);
+    if (entry->previous != nullptr) {
+        entry->previous->next = entry->next;
+    }
+    else {
+        list = entry->next;
+    }
+    if (entry->next != nullptr) {
+        entry->next->previous = entry->previous;
+    }
+    if (list == nullptr && entry->level < kLevels) {
+        occupied_[entry->level] &= ~(uint64_t(1) << entry->slot);
+    }
+    entry->level = -1;
+    entry->previous = entry->next = nullptr;
+    count_--;
+}
+
+TimerEntry* TimerWheel::take(int level, int slot) {
+    auto &list = head(level, slot);
+    auto entries = list;
+    list = nullptr;
+    if (level < kLevels) {
+        occupied_[level] &= ~(uint64_t(1) << slot);
+    }
+    for (auto entry = entries; entry != nullptr; entry = entry->next) {
+        entry->level = -1;
+        count_--;
+    }
+    return entries;
+}
+
+uint64_t TimerWheel::next() const {
+    auto next = kNever;
+    for (int level = 0; level < kLevels; level++) {
+        auto shift = level * kSlotBits;
+        auto digit = (now_ >> shift) & (kSlots - 1);
+        // Entries are always placed in a slot after the current one. Slots on higher levels are due when the wheel
+        // reaches their first tick, at which point their entries move down.
+        auto pending = digit == kSlots - 1 ? 0 : occupied_[level] & (~uint64_t(0) << (digit + 1));
+        if (pending == 0) {
+            continue;
+        }
+        auto slot = static_cast<uint64_t>(__builtin_ctzll(pending));
+        auto rotation = (now_ >> (shift + kSlotBits)) << (shift + kSlotBits);
+        next = std::min(next, rotation + (slot << shift));
+    }
+    if (overflow_ != nullptr) {
+        next = std::min(next, ((now_ >> (kLevels * kSlotBits)) + 1) << (kLevels * kSlotBits));
+    }
+    return next;
+}
+
+void TimerWheel::advance(uint64_t now, std::vector<TimerEntry *> &expired) {
+    uint64_t tick;
+    while ((tick = next()) <= now) {
+        now_ = tick;
+        // Higher levels first, since their entries may move into a slot of a lower level that is due now as well.
+        for (int level = kLevels; level > 0; level--) {
+            auto shift = level * kSlotBits;
+            if ((tick & ((uint64_t(1) << shift) - 1)) != 0) {
+                continue;
+            }
+            auto slot = level == kLevels ? 0 : static_cast<int>((tick >> shift) & (kSlots - 1));
+            for (auto entry = take(level, slot); entry != nullptr;) {
+                auto next = entry->next;
+                place(entry);
+                entry = next;
+            }
+        }
+        for (auto entry = take(0, static_cast<int>(tick & (kSlots - 1))); entry != nullptr;) {
+            auto next = entry->next;
+            entry->previous = entry->next = nullptr;
+            expired.push_back(entry);
+            entry = next;
+        }
+    }
+    now_ = std::max(now_, now);
+}
+
+}  // namespace s
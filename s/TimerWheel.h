@@ -0,0 +1,78 @@
+//
+//  TimerWheel.h
+//  Emojicode
+//
+
+#ifndef EMOJICODE_TIMER_WHEEL_H
+#define EMOJICODE_TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace s {
+
+/// An entry of a TimerWheel. Entries are linked into the slots of the wheel directly, so scheduling and cancelling
+/// never allocate.
+struct TimerEntry {
+    /// The tick at which the entry expires.
+    uint64_t deadline = 0;
+    /// Points back to the object owning this entry.
+    void *context = nullptr;
+
+    bool scheduled() const { return level >= 0; }
+
+private:
+    friend class TimerWheel;
+    TimerEntry *previous = nullptr;
+    TimerEntry *next = nullptr;
+    int level = -1;
+    int slot = 0;
+};
+
+/// Hierarchical timing wheel as described by Varghese and Lauck. Six levels of 64 slots each cover 2^36 ticks;
+/// entries beyond are kept in an overflow list until the wheel gets there. Entries are placed on the lowest level
+/// whose rotation contains their deadline and move down a level whenever the wheel reaches their slot, so
+/// scheduling and cancelling take constant time and advancing only visits slots that contain entries.
+class TimerWheel {
+public:
+    static constexpr int kLevels = 6;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    /// Returned by next() if no entry is scheduled.
+    static constexpr uint64_t kNever = UINT64_MAX;
+
+    explicit TimerWheel(uint64_t now = 0) : now_(now) {}
+
+    /// Schedules *entry* to expire at *deadline*, which is moved to the next tick if it already passed. An entry
+    /// that is already scheduled is rescheduled.
+    void schedule(TimerEntry *entry, uint64_t deadline);
+    /// Removes *entry* from the wheel. Does nothing if *entry* is not scheduled.
+    void cancel(TimerEntry *entry);
+    /// Advances the wheel to *now* and appends all entries whose deadline was reached to *expired*.
+    void advance(uint64_t now, std::vector<TimerEntry *> &expired);
+    /// Returns the next tick at which advance() has work to do, or kNever.
+    uint64_t next() const;
+
+    uint64_t now() const { return now_; }
+    size_t count() const { return count_; }
+
+private:
+    /// Links *entry* into the slot matching its deadline.
+    void place(TimerEntry *entry);
+    void unlink(TimerEntry *entry);
+    /// Removes all entries from the given slot and returns them as a list linked through TimerEntry::next.
+    TimerEntry* take(int level, int slot);
+    /// Returns the head of the list of the given slot. Level kLevels denotes the overflow list.
+    TimerEntry*& head(int level, int slot) { return level == kLevels ? overflow_ : slots_[level][slot]; }
+
+    uint64_t now_;
+    size_t count_ = 0;
+    uint64_t occupied_[kLevels] = {};
+    TimerEntry *slots_[kLevels][kSlots] = {};
+    TimerEntry *overflow_ = nullptr;
+};
+
+}  // namespace s
+
+#endif //EMOJICODE_TIMER_WHEEL_H
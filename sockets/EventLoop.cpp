@@ -0,0 +1,236 @@
+//
+//  EventLoop.cpp
+//  Emojicode
+//
+
+#include "Socket.h"
+#include "../runtime/Runtime.h"
+#include "../s/Error.h"
+#include <cerrno>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace sockets {
+
+/// A 📞 or 🏄 watched by an EventLoop. The registration retains the object, so its descriptor is not closed and
+/// reused while events may still be reported for it.
+struct Watch {
+    runtime::Object<void> *object;
+    int descriptor;
+    bool server;
+    runtime::Callable<void> accept;
+    runtime::Callable<void, runtime::Boolean, runtime::Boolean> ready;
+};
+
+/// Single-threaded reactor for 📞 and 🏄. Descriptors are registered edge-triggered for all events, so each
+/// descriptor is added once and callbacks are only called when its state changes. Callbacks must therefore read,
+/// write or accept until the operation would block.
+class EventLoop : public runtime::Object<EventLoop> {
+public:
+    /// The maximum number of events processed in one batch.
+    static constexpr int kBatchSize = 128;
+
+    explicit EventLoop(int epoll) : epoll_(epoll) {}
+
+    ~EventLoop() {
+        for (auto &pair : watches_) {
+            pair.second->object->release();
+            release(pair.second.get());
+        }
+        close(epoll_);
+    }
+
+    bool watch(std::unique_ptr<Watch> watch) {
+        struct epoll_event event{};
+        event.events = EPOLLET | EPOLLIN | EPOLLRDHUP | (watch->server ? 0 : EPOLLOUT);
+        event.data.ptr = watch.get();
+        auto previous = watches_.find(watch->object);
+        if (previous != watches_.end()) {
+            if (epoll_ctl(epoll_, EPOLL_CTL_MOD, watch->descriptor, &event) == -1) {
+                return false;
+            }
+            retain(watch.get());
+            retire(std::move(previous->second));
+            previous->second = std::move(watch);
+            return true;
+        }
+        if (epoll_ctl(epoll_, EPOLL_CTL_ADD, watch->descriptor, &event) == -1) {
+            return false;
+        }
+        watch->object->retain();
+        retain(watch.get());
+        watches_.emplace(watch->object, std::move(watch));
+        return true;
+    }
+
+    void unwatch(runtime::Object<void> *object) {
+        auto it = watches_.find(object);
+        if (it == watches_.end()) {
+            return;
+        }
+        // Fails if the descriptor was already closed, in which case the kernel removed it.
+        epoll_ctl(epoll_, EPOLL_CTL_DEL, it->second->descriptor, nullptr);
+        auto watch = std::move(it->second);
+        watches_.erase(it);
+        watch->object->release();
+        retire(std::move(watch));
+    }
+
+    /// Waits at most *timeout* microseconds for events and calls the callbacks of all descriptors that became
+    /// ready. Returns the number of events processed or -1 on error.
+    runtime::Integer poll(runtime::Integer timeout) {
+        struct epoll_event events[kBatchSize];
+        auto count = epoll_wait(epoll_, events, kBatchSize, milliseconds(timeout));
+        if (count == -1) {
+            return errno == EINTR ? 0 : -1;
+        }
+        depth_++;
+        for (int i = 0; i < count; i++) {
+            auto watch = static_cast<Watch *>(events[i].data.ptr);
+            if (watch->object == nullptr) {
+                continue;  // Unwatched by a callback earlier in this batch.
+            }
+            auto flags = events[i].events;
+            if (watch->server) {
+                watch->accept();
+            }
+            else {
+                watch->ready((flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0,
+                             (flags & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0);
+            }
+        }
+        if (--depth_ > 0) {
+            return count;  // A callback polled, the outer batch may still refer to the retired watches.
+        }
+        for (auto &watch : retired_) {
+            release(watch.get());
+        }
+        retired_.clear();
+        return count;
+    }
+
+    /// Processes events until stop() is called or no descriptors are watched anymore.
+    bool run() {
+        stopped_ = false;
+        while (!stopped_ && !watches_.empty()) {
+            if (poll(-1) == -1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void stop() { stopped_ = true; }
+    size_t count() const { return watches_.size(); }
+
+private:
+    static int milliseconds(runtime::Integer microseconds) {
+        if (microseconds < 0) {
+            return -1;
+        }
+        return static_cast<int>((microseconds + 999) / 1000);
+    }
+
+    static void retain(Watch *watch) {
+        if (watch->server) {
+            watch->accept.retain();
+        }
+        else {
+            watch->ready.retain();
+        }
+    }
+
+    static void release(Watch *watch) {
+        if (watch->server) {
+            watch->accept.release();
+        }
+        else {
+            watch->ready.release();
+        }
+    }
+
+    /// Releases *watch* once no pending event of the batches being dispatched can refer to it anymore.
+    void retire(std::unique_ptr<Watch> watch) {
+        if (depth_ == 0) {
+            release(watch.get());
+            return;
+        }
+        watch->object = nullptr;
+        retired_.emplace_back(std::move(watch));
+    }
+
+    int epoll_;
+    /// The number of batches being dispatched. Greater than one while a callback polls itself.
+    int depth_ = 0;
+    bool stopped_ = false;
+    std::unordered_map<runtime::Object<void> *, std::unique_ptr<Watch>> watches_;
+    std::vector<std::unique_ptr<Watch>> retired_;
+};
+
+extern "C" EventLoop* socketsEventLoopNew(runtime::Raiser *raiser) {
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll == -1) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return EventLoop::init(epoll);
+}
+
+extern "C" void socketsEventLoopWatchSocket(EventLoop *loop, Socket *socket,
+                                            runtime::Callable<void, runtime::Boolean, runtime::Boolean> callback,
+                                            runtime::Raiser *raiser) {
+    auto watch = std::unique_ptr<Watch>(new Watch());
+    watch->object = reinterpret_cast<runtime::Object<void> *>(socket);
+    watch->descriptor = socket->socket_;
+    watch->server = false;
+    watch->ready = callback;
+    EJC_COND_RAISE_IO_VOID(loop->watch(std::move(watch)), raiser);
+}
+
+extern "C" void socketsEventLoopWatchServer(EventLoop *loop, Server *server, runtime::Callable<void> callback,
+                                            runtime::Raiser *raiser) {
+    auto watch = std::unique_ptr<Watch>(new Watch());
+    watch->object = reinterpret_cast<runtime::Object<void> *>(server);
+    watch->descriptor = server->socket_;
+    watch->server = true;
+    watch->accept = callback;
+    EJC_COND_RAISE_IO_VOID(loop->watch(std::move(watch)), raiser);
+}
+
+extern "C" void socketsEventLoopUnwatchSocket(EventLoop *loop, Socket *socket) {
+    loop->unwatch(reinterpret_cast<runtime::Object<void> *>(socket));
+}
+
+extern "C" void socketsEventLoopUnwatchServer(EventLoop *loop, Server *server) {
+    loop->unwatch(reinterpret_cast<runtime::Object<void> *>(server));
+}
+
+extern "C" runtime::Integer socketsEventLoopPoll(EventLoop *loop, runtime::Integer timeout, runtime::Raiser *raiser) {
+    auto count = loop->poll(timeout);
+    if (count == -1) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return count;
+}
+
+extern "C" void socketsEventLoopRun(EventLoop *loop, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(loop->run(), raiser);
+}
+
+extern "C" void socketsEventLoopStop(EventLoop *loop) {
+    loop->stop();
+}
+
+extern "C" runtime::Integer socketsEventLoopCount(EventLoop *loop) {
+    return static_cast<runtime::Integer>(loop->count());
+}
+
+extern "C" void socketsEventLoopDestruct(EventLoop *loop) {
+    loop->~EventLoop();
+}
+
+}  // namespace sockets
+
+SET_INFO_FOR(sockets::EventLoop, sockets, 1f3a1)
@@ -2,15 +2,23 @@
 // Created by Theo Weidmann on 26.03.18.
 //
 
+#include "Socket.h"
 #include "../runtime/Runtime.h"
 #include "../s/Data.h"
 #include "../s/String.h"
 #include "../s/Error.h"
+#include "../s/Fiber.h"
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cerrno>
+#include <chrono>
 #include <csignal>
 #include <cstring>
+#include <fcntl.h>
 #include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
@@ -19,15 +27,107 @@ using s::Data;
 
 namespace sockets {
 
-class Socket : public runtime::Object<Socket> {
-public:
-    int socket_;
-};
+/// Returns true unless *descriptor* was made non-blocking.
+bool isBlocking(int descriptor) {
+    int flags = fcntl(descriptor, F_GETFL, 0);
+    return flags != -1 && (flags & O_NONBLOCK) == 0;
+}
+
+/// Returns true if the last operation on a non-blocking socket failed only because it would have blocked.
+bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+bool setBlocking(int descriptor, bool blocking) {
+    int flags = fcntl(descriptor, F_GETFL, 0);
+    if (flags == -1) {
+        return false;
+    }
+    flags = blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK;
+    return fcntl(descriptor, F_SETFL, flags) != -1;
+}
+
+bool setOption(int descriptor, int level, int option, int value) {
+    return setsockopt(descriptor, level, option, &value, sizeof(value)) != -1;
+}
+
+/// Sets the kernel buffer sizes of the socket. Sizes that are not positive are left unchanged.
+bool setBufferSizes(int descriptor, runtime::Integer receive, runtime::Integer send) {
+    return (receive <= 0 || setOption(descriptor, SOL_SOCKET, SO_RCVBUF,
+                                      static_cast<int>(std::min<runtime::Integer>(receive, INT32_MAX)))) &&
+           (send <= 0 || setOption(descriptor, SOL_SOCKET, SO_SNDBUF,
+                                   static_cast<int>(std::min<runtime::Integer>(send, INT32_MAX))));
+}
 
-class Server : public runtime::Object<Server> {
-public:
-    int socket_;
-};
+/// Returns the send or receive timeout of the socket in microseconds or -1 if it has none.
+int64_t timeout(int descriptor, bool writing) {
+    struct timeval value{};
+    socklen_t size = sizeof(value);
+    if (getsockopt(descriptor, SOL_SOCKET, writing ? SO_SNDTIMEO : SO_RCVTIMEO, &value, &size) == -1 ||
+        (value.tv_sec == 0 && value.tv_usec == 0)) {
+        return -1;
+    }
+    return static_cast<int64_t>(value.tv_sec) * 1000000 + value.tv_usec;
+}
+
+/// Calls *operation* with the flags to pass to send() or recv(). On a 🌿 the operation must not block the worker, so
+/// it is performed non-blocking and the 🌿 is suspended until the socket is ready whenever it would block. A socket
+/// made non-blocking with 🚦 is never waited for. The timeouts set with socketsSocketSetTimeout() are honored in both
+/// cases.
+template <typename Operation>
+ssize_t transfer(int descriptor, bool writing, Operation operation) {
+    if (!s::fiber::active() || !isBlocking(descriptor)) {
+        return operation(0);
+    }
+    auto limit = int64_t(-2);
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    while (true) {
+        auto result = operation(MSG_DONTWAIT);
+        if (result != -1 || !wouldBlock()) {
+            return result;
+        }
+        if (limit == -2) {
+            limit = timeout(descriptor, writing);
+            if (limit >= 0) {
+                deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(limit);
+            }
+        }
+        int64_t remaining = -1;
+        if (limit >= 0) {
+            remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) {
+                errno = EAGAIN;
+                return -1;
+            }
+        }
+        if (writing) {
+            s::fiber::waitWritable(descriptor, remaining);
+        }
+        else {
+            s::fiber::waitReadable(descriptor, remaining);
+        }
+    }
+}
+
+/// Accepts a client on the listener of *server* and returns the descriptor of the connection, created with the accept4()
+/// *flags*, or -1. Waits for a client unless *server* was made non-blocking. Another thread or 🌿 may take the client
+/// between the listener becoming readable and the call to accept4(), so accept4() is retried until it succeeds.
+int acceptConnection(Server *server, int flags) {
+    while (true) {
+        int connection = accept4(server->socket_, nullptr, nullptr, flags);
+        if (connection != -1 || !wouldBlock() || !server->blocking_) {
+            return connection;
+        }
+        if (s::fiber::active()) {
+            s::fiber::waitReadable(server->socket_);
+        }
+        else {
+            struct pollfd listener{server->socket_, POLLIN, 0};
+            poll(&listener, 1, -1);
+        }
+    }
+}
 
 extern "C" Socket* socketsSocketNewHost(String *host, runtime::Integer port, runtime::Raiser *raiser) {
     struct hostent *server = gethostbyname(host->stdString().c_str());
@@ -41,11 +141,15 @@ extern "C" Socket* socketsSocketNewHost(String *host, runtime::Integer port, run
     address.sin_family = PF_INET;
     address.sin_port = htons(port);
 
-    int socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
-    if (socketDescriptor == -1 || connect(socketDescriptor, reinterpret_cast<struct sockaddr *>(&address),
-                                          sizeof(address)) == -1) {
+    int socketDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socketDescriptor == -1) {
         EJC_RAISE(raiser, s::IOError::init());
     }
+    if (connect(socketDescriptor, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) == -1) {
+        auto error = s::IOError::init();
+        close(socketDescriptor);
+        EJC_RAISE(raiser, error);
+    }
 
     auto socket = Socket::init();
     socket->socket_ = socketDescriptor;
@@ -53,17 +157,25 @@ extern "C" Socket* socketsSocketNewHost(String *host, runtime::Integer port, run
 }
 
 extern "C" void socketsSocketClose(Socket *socket) {
-    close(socket->socket_);
+    if (socket->socket_ != -1) {
+        close(socket->socket_);
+        socket->socket_ = -1;
+    }
 }
 
 extern "C" void socketsSocketSend(Socket *socket, Data *data, runtime::Raiser *raiser) {
-    EJC_COND_RAISE_IO_VOID(send(socket->socket_, data->data.get(), data->count, 0) != -1, raiser);
+    auto sent = transfer(socket->socket_, true, [socket, data](int flags) {
+        return send(socket->socket_, data->data.get(), data->count, flags);
+    });
+    EJC_COND_RAISE_IO_VOID(sent != -1, raiser);
 }
 
 extern "C" Data* socketsSocketRead(Socket *socket, runtime::Integer count, runtime::Raiser *raiser) {
     auto bytes = runtime::allocate<runtime::Byte>(count);
 
-    auto read = recv(socket->socket_, bytes.get(), count, 0);
+    auto read = transfer(socket->socket_, false, [socket, &bytes, count](int flags) {
+        return recv(socket->socket_, bytes.get(), count, flags);
+    });
     if (read == -1) {
         EJC_RAISE(raiser, s::IOError::init());
     }
@@ -74,12 +186,74 @@ extern "C" Data* socketsSocketRead(Socket *socket, runtime::Integer count, runti
     return data;
 }
 
+extern "C" void socketsSocketSetBlocking(Socket *socket, runtime::Boolean blocking, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(setBlocking(socket->socket_, blocking), raiser);
+}
+
+extern "C" void socketsSocketSetTimeout(Socket *socket, runtime::Integer microseconds, runtime::Raiser *raiser) {
+    struct timeval value{};
+    if (microseconds > 0) {
+        value.tv_sec = static_cast<time_t>(microseconds / 1000000);
+        value.tv_usec = static_cast<suseconds_t>(microseconds % 1000000);
+    }
+    EJC_COND_RAISE_IO_VOID(setsockopt(socket->socket_, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value)) != -1 &&
+                           setsockopt(socket->socket_, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value)) != -1, raiser);
+}
+
+extern "C" void socketsSocketSetNoDelay(Socket *socket, runtime::Boolean enabled, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(setOption(socket->socket_, IPPROTO_TCP, TCP_NODELAY, enabled), raiser);
+}
+
+extern "C" void socketsSocketSetKeepAlive(Socket *socket, runtime::Boolean enabled, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(setOption(socket->socket_, SOL_SOCKET, SO_KEEPALIVE, enabled), raiser);
+}
+
+extern "C" void socketsSocketSetBufferSizes(Socket *socket, runtime::Integer receive, runtime::Integer send,
+                                            runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(setBufferSizes(socket->socket_, receive, send), raiser);
+}
+
+extern "C" runtime::Integer socketsSocketTrySend(Socket *socket, Data *data, runtime::Raiser *raiser) {
+    auto sent = send(socket->socket_, data->data.get(), data->count, MSG_DONTWAIT);
+    if (sent == -1) {
+        if (wouldBlock()) {
+            return 0;
+        }
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return sent;
+}
+
+extern "C" runtime::SimpleOptional<Data*> socketsSocketTryRead(Socket *socket, runtime::Integer count,
+                                                               runtime::Raiser *raiser) {
+    auto bytes = runtime::allocate<runtime::Byte>(count);
+
+    auto read = recv(socket->socket_, bytes.get(), count, MSG_DONTWAIT);
+    if (read == -1) {
+        if (!wouldBlock()) {
+            raiser->raise(s::IOError::init(), __FILE__);
+        }
+        return runtime::NoValue;
+    }
+
+    auto data = Data::init();
+    data->count = read;
+    data->data = bytes;
+    return data;
+}
+
 extern "C" void socketsServerClose(Server *server) {
-    close(server->socket_);
+    if (server->socket_ != -1) {
+        close(server->socket_);
+        server->socket_ = -1;
+    }
 }
 
-extern "C" Server* socketsServerNewPort(runtime::Integer port, runtime::Raiser *raiser) {
-    int listenerDescriptor = socket(PF_INET, SOCK_STREAM, 0);
+/// Creates a listening socket bound to *port* on all interfaces. If *shared* is true, SO_REUSEPORT is set so that
+/// the kernel distributes incoming connections among all sockets listening on the same port. The listener is always
+/// non-blocking so that a 🌿 can wait for clients; whether 🙋 waits is decided by Server::blocking_.
+Server* listenOn(runtime::Integer port, runtime::Integer backlog, bool shared, runtime::Raiser *raiser) {
+    int listenerDescriptor = socket(PF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
     if (listenerDescriptor == -1) {
         EJC_RAISE(raiser, s::IOError::init());
     }
@@ -89,11 +263,15 @@ extern "C" Server* socketsServerNewPort(runtime::Integer port, runtime::Raiser *
     name.sin_port = htons(port);
     name.sin_addr.s_addr = htonl(INADDR_ANY);
 
-    int reuse = 1;
-    if (setsockopt(listenerDescriptor, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char *>(&reuse), sizeof(int)) == -1 ||
+    int enable = 1;
+    if (setsockopt(listenerDescriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) == -1 ||
+        (shared && setsockopt(listenerDescriptor, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) == -1) ||
         bind(listenerDescriptor, reinterpret_cast<struct sockaddr *>(&name), sizeof(name)) == -1 ||
-        listen(listenerDescriptor, 10) == -1) {
-        EJC_RAISE(raiser, s::IOError::init());
+        listen(listenerDescriptor, backlog > 0 ? static_cast<int>(std::min<runtime::Integer>(backlog, INT32_MAX))
+                                               : SOMAXCONN) == -1) {
+        auto error = s::IOError::init();
+        close(listenerDescriptor);
+        EJC_RAISE(raiser, error);
     }
 
     auto server = Server::init();
@@ -101,13 +279,20 @@ extern "C" Server* socketsServerNewPort(runtime::Integer port, runtime::Raiser *
     return server;
 }
 
+extern "C" Server* socketsServerNewPort(runtime::Integer port, runtime::Raiser *raiser) {
+    return listenOn(port, 0, false, raiser);
+}
+
+extern "C" Server* socketsServerNewPortOptions(runtime::Integer port, runtime::Integer backlog,
+                                               runtime::Boolean shared, runtime::Raiser *raiser) {
+    return listenOn(port, backlog, shared, raiser);
+}
+
 extern "C" Socket* socketsServerAccept(Server *server, runtime::Raiser *raiser) {
     std::signal(SIGPIPE, SIG_IGN);
 
-    struct sockaddr_storage clientAddress{};
-    unsigned int addressSize = sizeof(clientAddress);
-    int connectionAddress = accept(server->socket_, reinterpret_cast<struct sockaddr *>(&clientAddress), &addressSize);
-
+    // accept4() does not inherit O_NONBLOCK from the listener, so the connection blocks.
+    int connectionAddress = acceptConnection(server, SOCK_CLOEXEC);
     if (connectionAddress == -1) {
         EJC_RAISE(raiser, s::IOError::init());
     }
@@ -117,7 +302,38 @@ extern "C" Socket* socketsServerAccept(Server *server, runtime::Raiser *raiser)
     return socket;
 }
 
-}  // namespace sockets
+extern "C" void socketsServerSetNoDelay(Server *server, runtime::Boolean enabled, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(setOption(server->socket_, IPPROTO_TCP, TCP_NODELAY, enabled), raiser);
+}
+
+extern "C" void socketsServerSetKeepAlive(Server *server, runtime::Boolean enabled, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(setOption(server->socket_, SOL_SOCKET, SO_KEEPALIVE, enabled), raiser);
+}
+
+extern "C" void socketsServerSetBufferSizes(Server *server, runtime::Integer receive, runtime::Integer send,
+                                            runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(setBufferSizes(server->socket_, receive, send), raiser);
+}
+
+extern "C" void socketsServerSetBlocking(Server *server, runtime::Boolean blocking) {
+    server->blocking_ = blocking;
+}
 
-SET_INFO_FOR(sockets::Socket, sockets, 1f4de)
-SET_INFO_FOR(sockets::Server, sockets, 1f3c4)
+extern "C" runtime::SimpleOptional<Socket*> socketsServerTryAccept(Server *server, runtime::Raiser *raiser) {
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int connection = acceptConnection(server, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (connection == -1) {
+        // ECONNABORTED means a client gave up before it was accepted, which is no reason to fail.
+        if (!wouldBlock() && errno != ECONNABORTED) {
+            raiser->raise(s::IOError::init(), __FILE__);
+        }
+        return runtime::NoValue;
+    }
+
+    auto socket = Socket::init();
+    socket->socket_ = connection;
+    return socket;
+}
+
+}  // namespace sockets
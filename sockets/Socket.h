@@ -0,0 +1,32 @@
+//
+//  Socket.h
+//  Emojicode
+//
+
+#ifndef EMOJICODE_SOCKETS_SOCKET_H
+#define EMOJICODE_SOCKETS_SOCKET_H
+
+#include "../runtime/Runtime.h"
+
+namespace sockets {
+
+class Socket : public runtime::Object<Socket> {
+public:
+    /// -1 once the socket was closed, so that the deinitializer does not close a descriptor that was reused.
+    int socket_;
+};
+
+class Server : public runtime::Object<Server> {
+public:
+    /// The listener is always non-blocking so that accepting on a 🌿 never blocks the worker. -1 once closed.
+    int socket_;
+    /// Whether accepting waits for a client, as set by 🚦.
+    bool blocking_ = true;
+};
+
+}  // namespace sockets
+
+SET_INFO_FOR(sockets::Socket, sockets, 1f4de)
+SET_INFO_FOR(sockets::Server, sockets, 1f3c4)
+
+#endif //EMOJICODE_SOCKETS_SOCKET_H
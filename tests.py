@@ -85,6 +85,19 @@ compilation_tests = [
     "valueTypeBoxCopySelf",
     "includer",
     "threads",
+    "threadPool",
+    "parallel",
+    "atomics",
+    "channel",
+    "synchronization",
+    "threadLocal",
+    "concurrentDictionary",
+    "greenThreads",
+    "fiberSockets",
+    "eventLoop",
+    "socketTimeout",
+    "sharedListeners",
+    "timers",
     "inferListLiteralFromExpec",
     "sequenceTypeNames",
     "typeValues",
@@ -116,8 +129,14 @@ library_tests = [
     "dataTest",
     "systemTest",
     "listTest",
+    "lazyTest",
+    "dequeTest",
+    "heapTest",
+    "btreeTest",
     "enumerator",
     "dictionaryTest",
+    "setTest",
+    "bitsetTest",
     "jsonTest",
     "fileTest"
 ]